@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../include/gen/workloads.hpp"
+
+using namespace std;
+
+/// <summary>
+/// Cost the search maximises, read from the JSON files of a run and divided by the number of line segments.
+/// </summary>
+struct Fitness {
+	string name;
+	/// <summary>
+	/// The flag of DAA writing the file, and the file.
+	/// </summary>
+	string flag;
+	string file;
+	string key;
+};
+
+const vector<Fitness> fitnesses = {
+	{ "time", "--stats-json stats.json", "stats.json", "sweep_us" },
+	{ "comparisons", "--counters", "counters.json", "status_comparisons" },
+	{ "tests", "--counters", "counters.json", "intersection_tests" },
+	{ "events", "--counters", "counters.json", "events" },
+	{ "rotations", "--counters", "counters.json", "avl_rotations" },
+	{ "height", "--counters", "counters.json", "max_status_height" },
+};
+
+/// <summary>
+/// Result of one run of DAA.
+/// </summary>
+struct Run {
+	bool ok;
+	bool timedOut;
+	int status;
+	/// <summary>
+	/// The cost per line segment.
+	/// </summary>
+	double cost;
+};
+
+/// <summary>
+/// Function to read a number from a flat JSON object.
+/// </summary>
+/// <returns>The number, 0 if the key is missing.</returns>
+double jsonNumber(const string& json, const string& key) {
+	size_t at = json.find("\"" + key + "\":");
+	if (at == string::npos)
+		return 0;
+	return atof(json.c_str() + at + key.size() + 3);
+}
+
+/// <summary>
+/// Function to run DAA on line segments.
+/// </summary>
+/// <param name="segments">The line segments.</param>
+/// <param name="samples">Number of runs, the lowest cost is taken to filter the noise of the time.</param>
+Run evaluate(const vector<RawSegment>& segments, const string& daa, const string& dir, const Fitness& fitness, int timeout, int samples) {
+	writeSegments(dir + "/input.txt", segments);
+	Run run = { true, false, 0, INFINITY };
+	for (int s = 0; s < samples; s++) {
+		string command = "cd " + dir + " && timeout " + to_string(timeout) + " " + daa
+			+ " --input input.txt --no-display " + fitness.flag + " > /dev/null 2>&1";
+		remove((dir + "/" + fitness.file).c_str());
+		int status = system(command.c_str());
+
+		ifstream file(dir + "/" + fitness.file);
+		string json((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || json.empty()) {
+			run.ok = false;
+			run.timedOut = WIFEXITED(status) && WEXITSTATUS(status) == 124;
+			run.status = status;
+			return run;
+		}
+		run.cost = min(run.cost, jsonNumber(json, fitness.key) / max<size_t>(segments.size(), 1));
+	}
+	return run;
+}
+
+/// <summary>
+/// Mutations of a set of line segments, each aimed at one of the pathological cases of the sweep:
+/// shared endpoints make long U and L sets, segments through a common point make long C sets, nearly
+/// parallel and nearly identical segments stress the fuzzy comparisons of the Status, and horizontal
+/// and overlapping segments are the degenerate cases.
+/// </summary>
+class Mutator {
+public:
+	Mutator(uint64_t seed) : rng(seed) {}
+
+	void mutate(vector<RawSegment>& segments) {
+		if (segments.empty())
+			return;
+		// Usually one change, sometimes a few
+		int changes = 1;
+		while (changes < 8 && unit(rng) < 0.3)
+			changes++;
+		for (int c = 0; c < changes; c++)
+			mutateOnce(segments);
+	}
+
+private:
+	void mutateOnce(vector<RawSegment>& segments) {
+		RawSegment& s = segments[pick(segments.size())];
+		const RawSegment& o = segments[pick(segments.size())];
+		const double pi = acos(-1.0);
+
+		switch (pick(8)) {
+		case 0: {	// jitter an endpoint, at one of several scales down to the epsilon of the comparisons
+			static const double scales[] = { 1e-4, 1e-2, 1, 50 };
+			normal_distribution<double> d(0, scales[pick(4)]);
+			if (pick(2))
+				s.x1 += d(rng), s.y1 += d(rng);
+			else
+				s.x2 += d(rng), s.y2 += d(rng);
+			break;
+		}
+		case 1:		// share an endpoint with another segment
+			if (pick(2))
+				s.x1 = o.x1, s.y1 = o.y1;
+			else
+				s.x2 = o.x2, s.y2 = o.y2;
+			break;
+		case 2: {	// pass through a point of another segment
+			double t = unit(rng);
+			through(s, o.x1 + t * (o.x2 - o.x1), o.y1 + t * (o.y2 - o.y1), unit(rng) * pi);
+			break;
+		}
+		case 3: {	// pass through the intersection point of two other segments
+			const RawSegment& q = segments[pick(segments.size())];
+			double d = (o.x2 - o.x1) * (q.y2 - q.y1) - (o.y2 - o.y1) * (q.x2 - q.x1);
+			if (fabs(d) < 1e-12)
+				break;
+			double t = ((q.x1 - o.x1) * (q.y2 - q.y1) - (q.y1 - o.y1) * (q.x2 - q.x1)) / d;
+			through(s, o.x1 + t * (o.x2 - o.x1), o.y1 + t * (o.y2 - o.y1), unit(rng) * pi);
+			break;
+		}
+		case 4: {	// nearly the same as another segment
+			uniform_real_distribution<double> offset(-1e-3, 1e-3);
+			s = { o.x1 + offset(rng), o.y1 + offset(rng), o.x2 + offset(rng), o.y2 + offset(rng) };
+			break;
+		}
+		case 5:		// horizontal
+			s.y2 = s.y1;
+			break;
+		case 6: {	// overlapping another segment on the same line
+			double a = unit(rng) * 1.5 - 0.25, b = unit(rng) * 1.5 - 0.25;
+			s = { o.x1 + a * (o.x2 - o.x1), o.y1 + a * (o.y2 - o.y1), o.x1 + b * (o.x2 - o.x1), o.y1 + b * (o.y2 - o.y1) };
+			break;
+		}
+		default: {	// a new random segment
+			uniform_real_distribution<double> coord(0, workloadSide);
+			s = { coord(rng), coord(rng), coord(rng), coord(rng) };
+			break;
+		}
+		}
+
+		// The sweep reads floats, so the coordinates are kept in the square and the segment does not collapse
+		for (double* v : { &s.x1, &s.y1, &s.x2, &s.y2 })
+			*v = min(max(*v, 0.0), workloadSide);
+		if (s.x1 == s.x2 && s.y1 == s.y2)
+			s.x2 += s.x2 + 1 <= workloadSide ? 1 : -1;
+	}
+
+	void through(RawSegment& s, double x, double y, double angle) {
+		double l1 = unit(rng) * workloadSide / 4, l2 = unit(rng) * workloadSide / 4;
+		s = { x - l1 * cos(angle), y - l1 * sin(angle), x + l2 * cos(angle), y + l2 * sin(angle) };
+	}
+
+	size_t pick(size_t n) {
+		return uniform_int_distribution<size_t>(0, n - 1)(rng);
+	}
+
+	mt19937_64 rng;
+	uniform_real_distribution<double> unit{ 0, 1 };
+};
+
+/// <summary>
+/// Function to save a case in the corpus.
+/// </summary>
+/// <returns>The path of the case.</returns>
+string save(const string& corpus, const string& name, const vector<RawSegment>& segments) {
+	mkdir(corpus.c_str(), 0755);
+	string path = corpus + "/" + name + ".txt";
+	if (!writeSegments(path, segments))
+		cerr << "Could not write " << path << '\n';
+	return path;
+}
+
+int main(int argc, char* argv[]) {
+
+	vector<string> starts = { "uniform", "short", "near-parallel", "one-point" };
+	string fitnessName = "comparisons";
+	size_t n = 64;
+	int generations = 200;
+	int children = 4;
+	int samples = 0;
+	int timeout = 10;
+	uint64_t seed = 1;
+	string daa = DAA_PATH;
+	string corpus = CORPUS_DIR;
+
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if (arg == "--fitness" && i + 1 < argc)
+			fitnessName = argv[++i];
+		else if (arg == "--start" && i + 1 < argc) {
+			starts.clear();
+			stringstream ss(argv[++i]);
+			string item;
+			while (getline(ss, item, ','))
+				starts.push_back(item);
+		}
+		else if (arg == "--n" && i + 1 < argc)
+			n = stoull(argv[++i]);
+		else if (arg == "--generations" && i + 1 < argc)
+			generations = atoi(argv[++i]);
+		else if (arg == "--children" && i + 1 < argc)
+			children = atoi(argv[++i]);
+		else if (arg == "--samples" && i + 1 < argc)
+			samples = atoi(argv[++i]);
+		else if (arg == "--timeout" && i + 1 < argc)
+			timeout = atoi(argv[++i]);
+		else if (arg == "--seed" && i + 1 < argc)
+			seed = stoull(argv[++i]);
+		else if (arg == "--daa" && i + 1 < argc)
+			daa = argv[++i];
+		else if (arg == "--corpus" && i + 1 < argc)
+			corpus = argv[++i];
+		else {
+			cerr << "Usage: " << argv[0] << " [--fitness name] [--start workload,...] [--n N] [--generations G] [--children C]\n"
+				<< "       [--samples S] [--timeout seconds] [--seed S] [--daa path] [--corpus dir]\n"
+				<< "Fitness, per line segment:";
+			for (const Fitness& f : fitnesses)
+				cerr << ' ' << f.name;
+			cerr << "\nStarts from the given bench workloads and keeps the mutations which do not lower the cost.\n"
+				<< "The worst case of every start, and every input failing or timing out, is saved in the corpus.\n";
+			return 1;
+		}
+	}
+
+	const Fitness* fitness = nullptr;
+	for (const Fitness& f : fitnesses)
+		if (f.name == fitnessName)
+			fitness = &f;
+	if (!fitness) {
+		cerr << "Unknown fitness " << fitnessName << '\n';
+		return 1;
+	}
+	if (samples <= 0)
+		samples = fitness->name == "time" ? 3 : 1;		// the counters do not change between runs
+
+	char dirTemplate[] = "/tmp/daa_adversarial_XXXXXX";
+	if (!mkdtemp(dirTemplate)) {
+		cerr << "Could not create a working directory\n";
+		return 1;
+	}
+	string dir = dirTemplate;
+
+	Mutator mutator(seed);
+	int failures = 0;
+	vector<RawSegment> parent, child;
+
+	for (const string& start : starts) {
+		if (!generateWorkload(start, n, seed, parent)) {
+			cerr << "Unknown workload " << start << '\n';
+			return 1;
+		}
+		Run best = evaluate(parent, daa, dir, *fitness, timeout, samples);
+		if (!best.ok) {
+			cerr << start << ": the start already fails\n";
+			continue;
+		}
+		double initial = best.cost;
+
+		for (int g = 0; g < generations; g++) {
+			for (int c = 0; c < children; c++) {
+				child = parent;
+				mutator.mutate(child);
+				Run run = evaluate(child, daa, dir, *fitness, timeout, samples);
+				if (!run.ok) {
+					// Crashes and hangs are the most valuable cases, they are kept whatever their cost
+					string name = string(run.timedOut ? "timeout-" : "failure-") + start + "-" + to_string(n) + "-" + to_string(seed)
+						+ "-" + to_string(failures++);
+					cerr << start << " generation " << g << ": " << (run.timedOut ? "timed out" : "failed with status " + to_string(run.status))
+						<< ", saved " << save(corpus, name, child) << '\n';
+					continue;
+				}
+				if (run.cost >= best.cost) {
+					if (run.cost > best.cost)
+						cerr << start << " generation " << g << ": " << fitness->name << " per segment " << run.cost << '\n';
+					best = run;
+					parent.swap(child);
+				}
+			}
+		}
+
+		string path = save(corpus, fitness->name + "-" + start + "-" + to_string(n) + "-" + to_string(seed), parent);
+		cout << start << ": " << fitness->name << " per segment " << initial << " -> " << best.cost
+			<< " (x" << (initial > 0 ? best.cost / initial : 0) << "), saved " << path << '\n';
+	}
+
+	system(("rm -rf " + dir).c_str());
+	return 0;
+}
@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../include/gen/workloads.hpp"
+#include "../include/stats/memory_accounting.hpp"
+
+using namespace std;
+
+/// <summary>
+/// Extra flags passed to the DAA executable for every engine.
+/// </summary>
+struct Engine {
+	string name;
+	string flags;
+};
+
+const vector<Engine> engines = {
+	{ "memory", "" },
+	{ "btree", "--status btree" },
+	{ "btree-no-finger", "--status btree --no-finger" },
+	{ "external", "--external --memory-budget 64" },
+};
+
+/// <summary>
+/// Function to split a comma separated list.
+/// </summary>
+vector<string> splitList(const string& s) {
+	vector<string> items;
+	stringstream ss(s);
+	string item;
+	while (getline(ss, item, ','))
+		if (!item.empty())
+			items.push_back(item);
+	return items;
+}
+
+/// <summary>
+/// Function to read a number from the flat JSON object written by --stats-json.
+/// </summary>
+/// <param name="json">The JSON text.</param>
+/// <param name="key">The key.</param>
+/// <returns>The number, 0 if the key is missing.</returns>
+double jsonNumber(const string& json, const string& key) {
+	size_t at = json.find("\"" + key + "\":");
+	if (at == string::npos)
+		return 0;
+	return atof(json.c_str() + at + key.size() + 3);
+}
+
+/// <summary>
+/// Phases and hardware counters reported by --perf-counters.
+/// </summary>
+const vector<string> perfPhases = { "input", "sweep", "output", "teardown" };
+const vector<string> perfCounters = { "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses" };
+/// <summary>
+/// Phases timed by the phase timers of DAA, missing when they are compiled out.
+/// </summary>
+const vector<string> timedPhases = { "parse", "build", "sweep", "event_pop", "status_update", "neighbours",
+	"find_new_event", "report", "output", "teardown" };
+
+int main(int argc, char* argv[]) {
+
+	vector<string> workloads = workloadNames();
+	vector<size_t> sizes = { 100, 1000, 10000, 100000, 1000000, 10000000 };
+	vector<string> engineNames = { "memory", "btree", "external" };
+	size_t maxN = 10000;
+	int repeats = 5;		// the fewest for which bench_compare.py can find a change significant at alpha = 0.05
+	int timeout = 600;
+	uint64_t seed = 1;
+	string daa = DAA_PATH;
+	string outPath;
+	vector<string> corpusFiles;
+
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if (arg == "--workloads" && i + 1 < argc)
+			workloads = splitList(argv[++i]);
+		else if (arg == "--n" && i + 1 < argc) {
+			sizes.clear();
+			for (string& s : splitList(argv[++i]))
+				sizes.push_back(stoull(s));
+			maxN = SIZE_MAX;
+		}
+		else if (arg == "--max-n" && i + 1 < argc)
+			maxN = stoull(argv[++i]);
+		else if (arg == "--engines" && i + 1 < argc)
+			engineNames = splitList(argv[++i]);
+		else if (arg == "--repeat" && i + 1 < argc)
+			repeats = atoi(argv[++i]);
+		else if (arg == "--timeout" && i + 1 < argc)
+			timeout = atoi(argv[++i]);
+		else if (arg == "--seed" && i + 1 < argc)
+			seed = stoull(argv[++i]);
+		else if (arg == "--daa" && i + 1 < argc)
+			daa = argv[++i];
+		else if (arg == "--out" && i + 1 < argc)
+			outPath = argv[++i];
+		else if (arg == "--corpus" && i + 1 < argc) {
+			error_code ec;
+			for (const auto& entry : filesystem::directory_iterator(argv[++i], ec))
+				if (entry.path().extension() == ".txt")
+					corpusFiles.push_back(entry.path().string());
+			sort(corpusFiles.begin(), corpusFiles.end());
+		}
+		else {
+			cerr << "Usage: " << argv[0] << " [--workloads a,b] [--n 100,1000 | --max-n N] [--engines memory,btree,external]\n"
+				<< "       [--repeat R] [--timeout seconds] [--seed S] [--daa path] [--out results.json]\n"
+				<< "       [--corpus dir]\n"
+				<< "Workloads:";
+			for (const string& w : workloadNames())
+				cerr << ' ' << w;
+			cerr << "\nn defaults to the powers of ten from 1e2 up to --max-n (1e4), at most 1e7.\n"
+				<< "The inputs saved by adversarial in the corpus directory are run as well, as the workloads corpus/<file>.\n";
+			return 1;
+		}
+	}
+
+	char dirTemplate[] = "/tmp/daa_bench_XXXXXX";
+	if (!mkdtemp(dirTemplate)) {
+		cerr << "Could not create a working directory\n";
+		return 1;
+	}
+	string dir = dirTemplate;
+
+	ofstream outFile;
+	if (!outPath.empty())
+		outFile.open(outPath);
+	ostream& out = outPath.empty() ? cout : outFile;
+
+	// One JSON record per run, in an array, so the results can be loaded and plotted directly
+	out << "[\n";
+	bool first = true;
+	vector<RawSegment> segments;
+
+	// Runs every engine on dir/input.txt
+	auto runEngines = [&](const string& workload, size_t n) {
+		for (const string& engineName : engineNames) {
+			const Engine* engine = nullptr;
+			for (const Engine& e : engines)
+				if (e.name == engineName)
+					engine = &e;
+			if (!engine) {
+				cerr << "Unknown engine " << engineName << '\n';
+				return false;
+			}
+
+			for (int r = 0; r < repeats; r++) {
+				string command = "cd " + dir + " && timeout " + to_string(timeout) + " " + daa
+					+ " --input input.txt --no-display --perf-counters --stats-json stats.json " + engine->flags + " > /dev/null 2>&1";
+				remove((dir + "/stats.json").c_str());
+
+				auto start = chrono::steady_clock::now();
+				int status = system(command.c_str());
+				auto stop = chrono::steady_clock::now();
+				double wall = chrono::duration<double>(stop - start).count();
+
+				ifstream statsFile(dir + "/stats.json");
+				string json((istreambuf_iterator<char>(statsFile)), istreambuf_iterator<char>());
+				bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0 && !json.empty();
+				bool timedOut = WIFEXITED(status) && WEXITSTATUS(status) == 124;
+
+				double events = jsonNumber(json, "events");
+				double sweep = jsonNumber(json, "sweep_us") / 1e6;
+
+				out << (first ? "" : ",\n") << "  {\"workload\": \"" << workload << "\", \"n\": " << n
+					<< ", \"engine\": \"" << engine->name << "\", \"repeat\": " << r
+					<< ", \"ok\": " << (ok ? "true" : "false") << ", \"timed_out\": " << (timedOut ? "true" : "false")
+					<< ", \"wall_s\": " << wall << ", \"sweep_s\": " << sweep
+					<< ", \"events\": " << (size_t)events
+					<< ", \"intersections\": " << (long long)jsonNumber(json, "intersection_points")
+					<< ", \"events_per_s\": " << (sweep > 0 ? events / sweep : 0)
+					<< ", \"segments_per_s\": " << (wall > 0 ? n / wall : 0)
+					<< ", \"rss_peak_bytes\": " << (size_t)jsonNumber(json, "rss_peak_bytes")
+					<< ", \"memory_peak_bytes\": {";
+				for (int i = 0; i < (int)MemoryTag::Count; i++)
+					out << '"' << MemoryAccounting::name(i) << "\": " << (long long)jsonNumber(json, string("memory_") + MemoryAccounting::name(i) + "_peak_bytes") << ", ";
+				out << "\"total\": " << (long long)jsonNumber(json, "memory_total_peak_bytes") << "}";
+
+				// Hardware counters per phase, null for the counters the kernel did not give access to
+				out << ", \"perf\": {";
+				for (size_t p = 0; p < perfPhases.size(); p++) {
+					out << (p ? ", " : "") << '"' << perfPhases[p] << "\": {";
+					for (size_t c = 0; c < perfCounters.size(); c++) {
+						string key = "perf_" + perfPhases[p] + "_" + perfCounters[c];
+						out << (c ? ", " : "") << '"' << perfCounters[c] << "\": ";
+						if (json.find("\"" + key + "\":") == string::npos)
+							out << "null";
+						else
+							out << (unsigned long long)jsonNumber(json, key);
+					}
+					out << "}";
+				}
+				out << "}";
+
+				if (json.find("\"phases_us\":") != string::npos) {
+					out << ", \"phases_us\": {";
+					for (size_t p = 0; p < timedPhases.size(); p++)
+						out << (p ? ", " : "") << '"' << timedPhases[p] << "\": " << (long long)jsonNumber(json, timedPhases[p]);
+					out << "}";
+				}
+				out << "}";
+				out.flush();
+				first = false;
+
+				cerr << workload << " n=" << n << ' ' << engine->name << " #" << r << ": "
+					<< (ok ? to_string(wall) + " s" : timedOut ? "timed out" : "failed") << '\n';
+				if (!ok)
+					break;		// the other repeats would fail the same way
+			}
+		}
+		return true;
+	};
+
+	for (const string& workload : workloads) {
+		for (size_t n : sizes) {
+			if (n > maxN)
+				continue;
+			if (!generateWorkload(workload, n, seed, segments)) {
+				cerr << "Unknown workload " << workload << '\n';
+				return 1;
+			}
+			writeSegments(dir + "/input.txt", segments);
+			if (!runEngines(workload, n))
+				return 1;
+		}
+	}
+
+	// The saved cases of the corpus run at their own size, named after their files
+	for (const string& path : corpusFiles) {
+		if (!readSegments(path, segments)) {
+			cerr << "Could not read " << path << '\n';
+			continue;
+		}
+		writeSegments(dir + "/input.txt", segments);
+		if (!runEngines("corpus/" + filesystem::path(path).stem().string(), segments.size()))
+			return 1;
+	}
+	out << "\n]\n";
+
+	system(("rm -rf " + dir).c_str());
+	return 0;
+}
@@ -0,0 +1,466 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../include/geometry/point.hpp"
+#include "../include/geometry/segment.hpp"
+#include "../include/geometry/Common.hpp"
+#include "../include/AVLTree/tree.hpp"
+#include "../include/AVLTree/compact.hpp"
+#include "../include/ds/btree.hpp"
+#include "../include/ds/event_queue.hpp"
+#include "../include/ds/status.hpp"
+#include "../include/stats/perf_counter.hpp"
+
+using namespace std;
+
+// Every allocation of the process goes through here, so the benchmarks can report allocations / op.
+// All the forms are replaced together, so that no block from one family is freed by another.
+// The parallel builds and set operations allocate from several threads, hence the atomic counter.
+static atomic<size_t> allocations{ 0 };
+
+/// <summary>
+/// Function to count and make an allocation, NULL if there is no memory.
+/// </summary>
+static void* allocate(size_t n, size_t alignment = 0) {
+	allocations.fetch_add(1, memory_order_relaxed);
+	if (!n)
+		n = 1;
+	if (alignment <= alignof(max_align_t))
+		return malloc(n);
+	return aligned_alloc(alignment, (n + alignment - 1) / alignment * alignment);	// the size must be a multiple of the alignment
+}
+
+/// <summary>
+/// Function to free an allocation. It is kept out of line so that GCC, inlining a delete into code where it sees the
+/// matching new, does not take the free() inside for a mismatch with new (-Wmismatched-new-delete).
+/// </summary>
+__attribute__((noinline)) static void release(void* p) {
+	free(p);
+}
+
+void* operator new(size_t n) {
+	if (void* p = allocate(n))
+		return p;
+	throw bad_alloc();
+}
+
+void* operator new[](size_t n) {
+	if (void* p = allocate(n))
+		return p;
+	throw bad_alloc();
+}
+
+void* operator new(size_t n, align_val_t a) {
+	if (void* p = allocate(n, (size_t)a))
+		return p;
+	throw bad_alloc();
+}
+
+void* operator new[](size_t n, align_val_t a) {
+	if (void* p = allocate(n, (size_t)a))
+		return p;
+	throw bad_alloc();
+}
+
+void* operator new(size_t n, const nothrow_t&) noexcept {
+	return allocate(n);
+}
+
+void* operator new[](size_t n, const nothrow_t&) noexcept {
+	return allocate(n);
+}
+
+void* operator new(size_t n, align_val_t a, const nothrow_t&) noexcept {
+	return allocate(n, (size_t)a);
+}
+
+void* operator new[](size_t n, align_val_t a, const nothrow_t&) noexcept {
+	return allocate(n, (size_t)a);
+}
+
+void operator delete(void* p) noexcept {
+	release(p);
+}
+
+void operator delete[](void* p) noexcept {
+	release(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+	release(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+	release(p);
+}
+
+void operator delete(void* p, align_val_t) noexcept {
+	release(p);
+}
+
+void operator delete[](void* p, align_val_t) noexcept {
+	release(p);
+}
+
+void operator delete(void* p, size_t, align_val_t) noexcept {
+	release(p);
+}
+
+void operator delete[](void* p, size_t, align_val_t) noexcept {
+	release(p);
+}
+
+void operator delete(void* p, const nothrow_t&) noexcept {
+	release(p);
+}
+
+void operator delete[](void* p, const nothrow_t&) noexcept {
+	release(p);
+}
+
+void operator delete(void* p, align_val_t, const nothrow_t&) noexcept {
+	release(p);
+}
+
+void operator delete[](void* p, align_val_t, const nothrow_t&) noexcept {
+	release(p);
+}
+
+/// <summary>
+/// Measurement of one operation over a batch of keys.
+/// </summary>
+struct Result {
+	string structure, key, pattern, op;
+	size_t ops;
+	double ns;
+	double allocs;
+	double misses;
+};
+
+vector<Result> results;
+PerfCounter* cacheMisses;
+
+/// <summary>
+/// Function to time an operation applied to ops keys.
+/// </summary>
+template <class F>
+void measure(const string& structure, const string& key, const string& pattern, const string& op, size_t ops, F f) {
+	size_t before = allocations.load(memory_order_relaxed);
+	cacheMisses->start();
+	auto start = chrono::steady_clock::now();
+	f();
+	auto stop = chrono::steady_clock::now();
+	uint64_t misses = cacheMisses->stop();
+
+	double n = (double)max<size_t>(ops, 1);
+	Result r = { structure, key, pattern, op, ops, chrono::duration<double, nano>(stop - start).count() / n,
+		(allocations.load(memory_order_relaxed) - before) / n, misses / n };
+	results.push_back(r);
+
+	printf("%-10s %-8s %-7s %-11s %12.1f %10.2f ", structure.c_str(), key.c_str(), pattern.c_str(), op.c_str(), r.ns, r.allocs);
+	if (cacheMisses->available())
+		printf("%12.2f\n", r.misses);
+	else
+		printf("%12s\n", "n/a");
+}
+
+/// <summary>
+/// Orders the keys with their own operator <, for std::set and std::sort.
+/// </summary>
+template <class K>
+struct Less {
+	bool operator()(const K& a, const K& b) const {
+		return const_cast<K&>(a) < const_cast<K&>(b);
+	}
+};
+
+/// <summary>
+/// Line segment crossing the sweep line y = 0 at x, all of them parallel so that their order never changes.
+/// </summary>
+Segment segmentAt(float x, int id = -1) {
+	return Segment(Point(x - 0.5f, -1), Point(x + 0.5f, 1), id);
+}
+
+template <class Tree, class K>
+struct AvlBench {
+	Tree t;
+	void insert(K& k) { t.insert(k); }
+	bool find(K& k) { return t.search(k) != nullptr; }
+	void remove(K& k) { t.remove(k); }
+	void difference(AvlBench& o) { t.difference(o.t); }
+	int neighbours(Point p) { return t.leftNeighbourOfPoint(p).id + t.rightNeighbourOfPoint(p).id; }
+};
+
+template <class K>
+struct SetBench {
+	set<K, Less<K>> t;
+	void insert(K& k) { t.insert(k); }
+	bool find(K& k) { return t.find(k) != t.end(); }
+	void remove(K& k) { t.erase(k); }
+	void difference(SetBench& o) {
+		for (const K& k : o.t)
+			t.erase(k);
+	}
+	int neighbours(Point p) {
+		auto it = t.lower_bound(segmentAt(p.x));
+		int right = it != t.end() ? it->id : -1;
+		int left = it != t.begin() ? prev(it)->id : -1;
+		return left + right;
+	}
+};
+
+template <class K>
+struct BTreeBench {
+	BTree<K> t;
+	void insert(K& k) { t.insert(k); }
+	bool find(K& k) { return t.search(k) != nullptr; }
+	void remove(K& k) { t.remove(k); }
+	void difference(BTreeBench& o) {
+		for (auto it = o.t.begin(); it.valid(); ++it)
+			t.remove(*it);
+	}
+	int neighbours(Point p) {
+		auto it = t.lowerBound(segmentAt(p.x));
+		int right = it.valid() ? it->id : -1;
+		if (it.valid())
+			--it;
+		else
+			it = t.last();
+		int left = it.valid() ? it->id : -1;
+		return left + right;
+	}
+};
+
+template <class K>
+struct CompactBench {
+	CompactTree<K> t;
+	void insert(K& k) { t.insert(k); }
+	bool find(K& k) { return t.search(k) != nullptr; }
+	void remove(K& k) { t.remove(k); }
+	void difference(CompactBench& o) {
+		o.t.forEach([this](K& k) { t.remove(k); });
+	}
+	int neighbours(Point p) {
+		K* right = t.lowerBound(segmentAt(p.x));
+		K* left = t.predecessor(segmentAt(p.x));
+		return (left ? left->id : -1) + (right ? right->id : -1);
+	}
+};
+
+/// <summary>
+/// Function to run the operations on one structure: insert, search, neighbour queries (line segments only),
+/// difference with a tree holding every other key, and remove of the remaining keys.
+/// </summary>
+template <class Bench, class K>
+void runStructure(const string& structure, const string& key, const string& pattern, vector<K>& keys, vector<float>& probes) {
+	Bench* b = new Bench();
+	long long sink = 0;
+
+	measure(structure, key, pattern, "insert", keys.size(), [&] {
+		for (K& k : keys)
+			b->insert(k);
+	});
+	measure(structure, key, pattern, "search", keys.size(), [&] {
+		for (K& k : keys)
+			sink += b->find(k);
+	});
+	if constexpr (is_same<K, Segment>::value) {
+		measure(structure, key, pattern, "neighbours", probes.size(), [&] {
+			for (float x : probes)
+				sink += b->neighbours(Point(x, 0));
+		});
+	}
+
+	Bench* other = new Bench();
+	for (size_t i = 0; i < keys.size(); i += 2)
+		other->insert(keys[i]);
+	measure(structure, key, pattern, "difference", (keys.size() + 1) / 2, [&] {
+		b->difference(*other);
+	});
+	measure(structure, key, pattern, "remove", keys.size() / 2, [&] {
+		for (size_t i = 1; i < keys.size(); i += 2)
+			b->remove(keys[i]);
+	});
+
+	delete other;
+	delete b;
+	if (sink == 42)		// keep the searches from being optimised away
+		printf(" ");
+}
+
+/// <summary>
+/// Function to run the event queue operations: insert all the points, then top() and pop() until it is empty.
+/// </summary>
+void runEventQueue(const string& pattern, vector<Point>& points) {
+	size_t n = points.size();
+	float sink = 0;
+	{
+		EventQueue<Point> eq;
+		for (Point& p : points)
+			eq.insert(p);
+		measure("avl", "point", pattern, "top+pop", n, [&] {
+			while (!eq.empty()) {
+				sink += eq.top().x;
+				eq.pop();
+			}
+		});
+	}
+	{
+		set<Point, Less<Point>> eq(points.begin(), points.end());
+		measure("std::set", "point", pattern, "top+pop", n, [&] {
+			while (!eq.empty()) {
+				sink += eq.begin()->x;
+				eq.erase(eq.begin());
+			}
+		});
+	}
+	{
+		BTree<Point> eq;
+		for (Point& p : points)
+			eq.insert(p);
+		measure("btree", "point", pattern, "top+pop", n, [&] {
+			while (!eq.empty()) {
+				Point p = *eq.begin();
+				sink += p.x;
+				eq.remove(p);
+			}
+		});
+	}
+	if (sink == 42)
+		printf(" ");
+}
+
+/// <summary>
+/// Function to run all the structures on one key type, with the keys in random and in sorted (sweep) order.
+/// </summary>
+template <class K>
+void runKey(const string& key, vector<K> keys, vector<float>& probes, mt19937_64& rng) {
+	for (string pattern : { "random", "sweep" }) {
+		if (pattern == "random")
+			shuffle(keys.begin(), keys.end(), rng);
+		else
+			sort(keys.begin(), keys.end(), Less<K>());
+
+		if constexpr (is_same<K, Segment>::value)
+			runStructure<AvlBench<Status, K>>("avl", key, pattern, keys, probes);
+		else
+			runStructure<AvlBench<AVLTree<K>, K>>("avl", key, pattern, keys, probes);
+		runStructure<SetBench<K>>("std::set", key, pattern, keys, probes);
+		runStructure<CompactBench<K>>("compact", key, pattern, keys, probes);
+		runStructure<BTreeBench<K>>("btree", key, pattern, keys, probes);
+
+		if constexpr (is_same<K, Point>::value)
+			runEventQueue(pattern, keys);
+
+		// Sorted keys can be built into a tree directly
+		if (pattern == "sweep") {
+			AVLTree<K> t;
+			measure("avl", key, pattern, "build", keys.size(), [&] {
+				t.build(keys.begin(), keys.end());
+			});
+			t.clear();
+			measure("avl", key, pattern, "build-par", keys.size(), [&] {
+				t.buildParallel(keys.begin(), keys.end(), 0);
+			});
+			// and frozen once it is only searched
+			FrozenTree<K> frozen;
+			measure("avl", key, pattern, "freeze", keys.size(), [&] {
+				frozen = t.freeze();
+			});
+			size_t found = 0;
+			measure("frozen", key, pattern, "search", keys.size(), [&] {
+				for (K& k : keys)
+					found += frozen.search(k) != nullptr;
+			});
+			if (found == 42)
+				printf(" ");
+		}
+	}
+}
+
+/// <summary>
+/// Microbenchmarks of the AVL Tree, EventQueue and Status against std::set, the Compact Tree and a B+ Tree on the key
+/// types of the sweep.
+/// </summary>
+int main(int argc, char* argv[]) {
+
+	size_t n = 10000;
+	uint64_t seed = 1;
+	string outPath;
+
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if (arg == "--n" && i + 1 < argc)
+			n = stoull(argv[++i]);
+		else if (arg == "--seed" && i + 1 < argc)
+			seed = stoull(argv[++i]);
+		else if (arg == "--out" && i + 1 < argc)
+			outPath = argv[++i];
+		else {
+			cerr << "Usage: " << argv[0] << " [--n keys] [--seed S] [--out results.json]\n";
+			return 1;
+		}
+	}
+
+	cacheMisses = new PerfCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+	if (!cacheMisses->available())
+		cerr << "Cache misses are not available (perf_event_open denied)\n";
+
+	mt19937_64 rng(seed);
+	uniform_real_distribution<float> coord(0, 1000);
+
+	// The keys are spaced well apart of the eps of the comparisons
+	vector<float> xs(n);
+	for (size_t i = 0; i < n; i++)
+		xs[i] = (float)i * 1000 / n + coord(rng) * 1e-4f;
+	shuffle(xs.begin(), xs.end(), rng);
+
+	vector<Point> points;
+	vector<Segment> segments;
+	vector<Common> commons;
+	for (size_t i = 0; i < n; i++) {
+		Point p(xs[i], coord(rng));
+		points.push_back(p);
+		segments.push_back(segmentAt(xs[i], (int)i));
+		Common c(p);
+		c.segments.push_back(segments.back());
+		commons.push_back(c);
+	}
+	vector<float> probes(n);
+	for (float& x : probes)
+		x = coord(rng);
+
+	Segment::k = 0;		// the sweep line of the Status
+	printf("%-10s %-8s %-7s %-11s %12s %10s %12s\n", "structure", "key", "pattern", "op", "ns/op", "allocs/op", "misses/op");
+	runKey("point", points, probes, rng);
+	runKey("segment", segments, probes, rng);
+	runKey("common", commons, probes, rng);
+
+	if (!outPath.empty()) {
+		ofstream out(outPath);
+		out << "[\n";
+		for (size_t i = 0; i < results.size(); i++) {
+			Result& r = results[i];
+			out << "  {\"structure\": \"" << r.structure << "\", \"key\": \"" << r.key << "\", \"pattern\": \"" << r.pattern
+				<< "\", \"op\": \"" << r.op << "\", \"n\": " << n << ", \"ops\": " << r.ops << ", \"ns_per_op\": " << r.ns
+				<< ", \"allocs_per_op\": " << r.allocs << ", \"cache_misses_per_op\": ";
+			if (cacheMisses->available())
+				out << r.misses;
+			else
+				out << "null";
+			out << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+		}
+		out << "]\n";
+	}
+	return 0;
+}
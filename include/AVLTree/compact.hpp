@@ -0,0 +1,527 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "../stats/counters.hpp"
+#include "../stats/memory_accounting.hpp"
+
+template <class T, MemoryTag Tag = MemoryTag::Other>
+/// <summary>
+/// Defines an AVL Tree whose nodes are kept in a single vector and linked by 32-bit indices instead of pointers.
+/// A node holds the data, two indices and a height byte, the links taking 8 bytes instead of 16, and the nodes
+/// of the freed slots are reused before the vector grows. As no node points into memory, the tree can be moved
+/// or copied with its vector and written to a file as it is.
+/// </summary>
+/// <typeparam name="T">A template class.</typeparam>
+/// <typeparam name="Tag">The data structure the memory of the nodes is accounted to.</typeparam>
+class CompactTree {
+public:
+	/// <summary>
+	/// Index standing for no node.
+	/// </summary>
+	static constexpr uint32_t nil = UINT32_MAX;
+
+private:
+	/// <summary>
+	/// Defines the structure of a node of the Compact Tree.
+	/// </summary>
+	struct Slot {
+		/// <summary>
+		/// Stores the data of the node.
+		/// </summary>
+		T data;
+		/// <summary>
+		/// Index of the left child, or of the next free slot when the slot is free.
+		/// </summary>
+		uint32_t leftChild;
+		/// <summary>
+		/// Index of the right child.
+		/// </summary>
+		uint32_t rightChild;
+		/// <summary>
+		/// Number of nodes on the longest path from the node down to a leaf, 1 for a leaf.
+		/// </summary>
+		uint8_t height;
+	};
+
+	/// <summary>
+	/// The nodes, including the free slots.
+	/// </summary>
+	std::vector<Slot, TaggedAllocator<Slot, Tag>> nodes_;
+	/// <summary>
+	/// Index of the root node.
+	/// </summary>
+	uint32_t root_;
+	/// <summary>
+	/// Index of the first free slot, the others being linked through their leftChild.
+	/// </summary>
+	uint32_t free_;
+	/// <summary>
+	/// Number of nodes in the tree.
+	/// </summary>
+	uint32_t size_;
+
+	/// <summary>
+	/// Function to get a node from its index. The reference is only valid until the next node is allocated.
+	/// </summary>
+	Slot& at(uint32_t i) {
+		return nodes_[i];
+	}
+
+	/// <summary>
+	/// Function to allocate a new node, in a free slot if there is one.
+	/// </summary>
+	/// <param name="val">The data of the node.</param>
+	/// <returns>The index of the node.</returns>
+	uint32_t newNode(T& val) {
+		uint32_t i = free_;
+		if (i != nil)
+			free_ = at(i).leftChild;
+		else {
+			if (nodes_.size() >= nil)	// the next index would read as no node
+				throw std::length_error("CompactTree cannot hold more than 2^32 - 1 nodes");
+			i = (uint32_t)nodes_.size();
+			nodes_.emplace_back();
+		}
+		Slot& s = at(i);
+		s.data = val;
+		s.leftChild = nil;
+		s.rightChild = nil;
+		s.height = 1;
+		size_++;
+		return i;
+	}
+
+	/// <summary>
+	/// Function to put a node on the free list.
+	/// </summary>
+	/// <param name="i">The index of the node.</param>
+	void deleteNode(uint32_t i) {
+		at(i).data = T();	// release what the data holds now rather than when the slot is reused
+		at(i).leftChild = free_;
+		free_ = i;
+		size_--;
+	}
+
+	/// <summary>
+	/// Function to get the height of a node, 0 for no node.
+	/// </summary>
+	int height(uint32_t i) {
+		return i == nil ? 0 : at(i).height;
+	}
+
+	/// <summary>
+	/// Function to calculate the balance factor of a node.
+	/// </summary>
+	int balanceFactor(uint32_t i) {
+		return height(at(i).leftChild) - height(at(i).rightChild);
+	}
+
+	/// <summary>
+	/// Function to recompute the height of a node from its children.
+	/// </summary>
+	void update(uint32_t i) {
+		int left = height(at(i).leftChild);
+		int right = height(at(i).rightChild);
+		at(i).height = (uint8_t)(1 + ((left > right) ? left : right));
+	}
+
+	/// <summary>
+	/// Function to right rotate the tree at the given node.
+	/// </summary>
+	/// <returns>The index of the new root node at the point of rotation.</returns>
+	uint32_t RR(uint32_t root) {
+		if (countersOn)
+			counters().rotations++;
+		uint32_t l = at(root).leftChild;
+		at(root).leftChild = at(l).rightChild;
+		at(l).rightChild = root;
+		update(root);
+		update(l);
+		return l;
+	}
+
+	/// <summary>
+	/// Function to left rotate the tree at the given node.
+	/// </summary>
+	/// <returns>The index of the new root node at the point of rotation.</returns>
+	uint32_t LR(uint32_t root) {
+		if (countersOn)
+			counters().rotations++;
+		uint32_t r = at(root).rightChild;
+		at(root).rightChild = at(r).leftChild;
+		at(r).leftChild = root;
+		update(root);
+		update(r);
+		return r;
+	}
+
+	/// <summary>
+	/// Function to restore the balance of a node after an insertion or a deletion below it.
+	/// </summary>
+	/// <returns>The index of the node now at its position.</returns>
+	uint32_t rebalance(uint32_t root) {
+		update(root);
+		if (balanceFactor(root) > 1) {
+			uint32_t l = at(root).leftChild;
+			if (height(at(l).leftChild) < height(at(l).rightChild))
+				at(root).leftChild = LR(l);
+			root = RR(root);
+		}
+		else if (balanceFactor(root) < -1) {
+			uint32_t r = at(root).rightChild;
+			if (height(at(r).leftChild) > height(at(r).rightChild))
+				at(root).rightChild = RR(r);
+			root = LR(root);
+		}
+		return root;
+	}
+
+	/// <summary>
+	/// Function to insert a node into a subtree.
+	/// </summary>
+	/// <param name="root">The index of the root node of the subtree.</param>
+	/// <param name="val">The data of the node to be inserted.</param>
+	/// <returns>The index of the root node of the subtree after the insertion.</returns>
+	uint32_t insertNode(uint32_t root, T& val) {
+		if (root == nil)
+			return newNode(val);
+		else if (val == at(root).data)
+			return root;
+		else if (val < at(root).data) {
+			uint32_t child = insertNode(at(root).leftChild, val);	// the vector may have grown
+			at(root).leftChild = child;
+		}
+		else {
+			uint32_t child = insertNode(at(root).rightChild, val);
+			at(root).rightChild = child;
+		}
+		return rebalance(root);
+	}
+
+	/// <summary>
+	/// Function to unlink the maximum node of a subtree by walking down its right edge.
+	/// </summary>
+	/// <param name="root">The index of the root node of the subtree.</param>
+	/// <param name="max">Variable which will be changed to the index of the unlinked node.</param>
+	/// <returns>The index of the root node of the rest of the subtree.</returns>
+	uint32_t detachMax(uint32_t root, uint32_t& max) {
+		if (at(root).rightChild == nil) {
+			max = root;
+			return at(root).leftChild;
+		}
+		at(root).rightChild = detachMax(at(root).rightChild, max);
+		return rebalance(root);
+	}
+
+	/// <summary>
+	/// Function to remove a node from a subtree.
+	/// </summary>
+	/// <param name="root">The index of the root node of the subtree.</param>
+	/// <param name="val">The data of the node to be removed.</param>
+	/// <returns>The index of the root node of the subtree after the deletion.</returns>
+	uint32_t removeNode(uint32_t root, T& val) {
+		if (root == nil)
+			return nil;
+
+		if (val < at(root).data)
+			at(root).leftChild = removeNode(at(root).leftChild, val);
+		else if (val > at(root).data)
+			at(root).rightChild = removeNode(at(root).rightChild, val);
+		else {
+			uint32_t left = at(root).leftChild;
+			uint32_t right = at(root).rightChild;
+			if (left == nil || right == nil) {
+				deleteNode(root);
+				return left == nil ? right : left;
+			}
+			// Replace the data with the maximum of the left subtree and unlink that node structurally
+			uint32_t max;
+			at(root).leftChild = detachMax(left, max);
+			at(root).data = at(max).data;
+			deleteNode(max);
+		}
+		return rebalance(root);
+	}
+
+	/// <summary>
+	/// Function to remove the leftmost node of a subtree by walking down its left edge, without comparing any data.
+	/// </summary>
+	/// <returns>The index of the root node of the subtree after the deletion.</returns>
+	uint32_t removeLeftmost(uint32_t root) {
+		if (at(root).leftChild == nil) {
+			uint32_t right = at(root).rightChild;
+			deleteNode(root);
+			return right;
+		}
+		at(root).leftChild = removeLeftmost(at(root).leftChild);
+		return rebalance(root);
+	}
+
+	/// <summary>
+	/// Function to build a perfectly balanced subtree from a sorted range, the middle element becoming its root.
+	/// </summary>
+	/// <returns>The index of the root node of the subtree.</returns>
+	template <class It>
+	uint32_t buildRange(It first, It last) {
+		if (first == last)
+			return nil;
+		It middle = first + (last - first) / 2;
+		uint32_t root = newNode(*middle);
+		uint32_t left = buildRange(first, middle);
+		uint32_t right = buildRange(middle + 1, last);
+		at(root).leftChild = left;
+		at(root).rightChild = right;
+		update(root);
+		return root;
+	}
+
+	/// <summary>
+	/// Function to visit the nodes of a subtree in order.
+	/// </summary>
+	template <class F>
+	void visit(uint32_t root, F& f) {
+		if (root == nil)
+			return;
+		visit(at(root).leftChild, f);
+		f(at(root).data);
+		visit(at(root).rightChild, f);
+	}
+
+	// Helper functions related to the Compact Tree
+	//insert()- to insert a node into the tree
+	//remove()- to remove a node from the tree
+	//removeMin()- to remove the smallest node
+	//build()- to replace the tree with a sorted range
+	//search()- to find if a given data is in the tree or not
+	//lowerBound()/predecessor()- to find the elements around a given data
+	//forEach()- to visit the elements in order
+	//save()/load()- to write the tree to a file and read it back
+public:
+
+	/// <summary>
+	/// Constructor to initialize the Compact Tree.
+	/// </summary>
+	CompactTree() {
+		root_ = nil;
+		free_ = nil;
+		size_ = 0;
+	}
+
+	/// <summary>
+	/// Function to insert a node into the Compact Tree.
+	/// </summary>
+	/// <param name="val">The data of the node to be inserted.</param>
+	void insert(T val) {
+		root_ = insertNode(root_, val);
+	}
+
+	/// <summary>
+	/// Function to remove a node from the Compact Tree.
+	/// </summary>
+	/// <param name="val">The data of the node to be removed.</param>
+	void remove(T val) {
+		root_ = removeNode(root_, val);
+	}
+
+	/// <summary>
+	/// Function to remove the smallest node of the Compact Tree.
+	/// </summary>
+	void removeMin() {
+		if (root_ != nil)
+			root_ = removeLeftmost(root_);
+	}
+
+	/// <summary>
+	/// Function to replace the contents of the Compact Tree with a sorted range in O(n), the nodes being laid out
+	/// in the vector in the order they are built, each root before its subtrees.
+	/// </summary>
+	/// <param name="first">Random access iterator to the first element of the range.</param>
+	/// <param name="last">Random access iterator past the last element of the range.</param>
+	/// <remarks>The range must be sorted in the order of the tree and hold no equal elements.</remarks>
+	template <class It>
+	void build(It first, It last) {
+		clear();
+		nodes_.reserve(last - first);
+		root_ = buildRange(first, last);
+	}
+
+	/// <summary>
+	/// Function to search the Compact Tree.
+	/// </summary>
+	/// <param name="val">The data searched for.</param>
+	/// <returns>The pointer to the matched data, NULL if there is none. It is only valid until the next insertion.</returns>
+	T* search(T val) {
+		uint32_t i = root_;
+		while (i != nil) {
+			Slot& s = at(i);
+			if (s.data == val)
+				return &s.data;
+			i = val < s.data ? s.leftChild : s.rightChild;
+		}
+		return nullptr;
+	}
+
+	/// <summary>
+	/// Function to find the first element not less than val.
+	/// </summary>
+	/// <returns>The pointer to the element, NULL if all the elements are less than val.</returns>
+	T* lowerBound(T val) {
+		T* found = nullptr;
+		for (uint32_t i = root_; i != nil;) {
+			Slot& s = at(i);
+			if (s.data < val)
+				i = s.rightChild;
+			else {
+				found = &s.data;
+				i = s.leftChild;
+			}
+		}
+		return found;
+	}
+
+	/// <summary>
+	/// Function to find the last element less than val.
+	/// </summary>
+	/// <returns>The pointer to the element, NULL if there is none.</returns>
+	T* predecessor(T val) {
+		T* found = nullptr;
+		for (uint32_t i = root_; i != nil;) {
+			Slot& s = at(i);
+			if (s.data < val) {
+				found = &s.data;
+				i = s.rightChild;
+			}
+			else
+				i = s.leftChild;
+		}
+		return found;
+	}
+
+	/// <summary>
+	/// Function to call f on every element of the Compact Tree in order.
+	/// </summary>
+	template <class F>
+	void forEach(F f) {
+		visit(root_, f);
+	}
+
+	/// <summary>
+	/// Function to delete all the nodes in the Compact Tree, keeping the memory of the vector for reuse.
+	/// </summary>
+	void clear() {
+		nodes_.clear();
+		root_ = nil;
+		free_ = nil;
+		size_ = 0;
+	}
+
+	/// <summary>
+	/// Function to get the number of nodes in the Compact Tree.
+	/// </summary>
+	size_t size() {
+		return size_;
+	}
+
+	/// <summary>
+	/// Function to check if the Compact Tree is empty.
+	/// </summary>
+	bool empty() {
+		return size_ == 0;
+	}
+
+	/// <summary>
+	/// Function to get the height of the Compact Tree.
+	/// </summary>
+	/// <returns>The number of nodes on the longest path from the root to a leaf.</returns>
+	int treeHeight() {
+		return height(root_);
+	}
+
+	/// <summary>
+	/// Function to get the number of bytes held by the nodes, the free slots included.
+	/// </summary>
+	size_t bytes() {
+		return nodes_.capacity() * sizeof(Slot);
+	}
+
+	/// <summary>
+	/// Function to write the Compact Tree to a file: a header with the root, the free list and the number of
+	/// nodes and slots, then the slots exactly as they are in memory.
+	/// </summary>
+	/// <param name="file">The file, open for writing in binary mode.</param>
+	/// <returns>True if everything was written.</returns>
+	bool save(std::FILE* file) {
+		static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable data can be saved as it is");
+		uint32_t header[4] = { root_, free_, size_, (uint32_t)nodes_.size() };
+		return std::fwrite(header, sizeof header, 1, file) == 1
+			&& std::fwrite(nodes_.data(), sizeof(Slot), nodes_.size(), file) == nodes_.size();
+	}
+
+	/// <summary>
+	/// Function to replace the Compact Tree with one written by save(), on a machine with the same layout of T.
+	/// The header is checked against the file, every index against the number of slots, and every slot must be
+	/// reached exactly once from the root or the free list, so that a truncated or corrupted file is refused
+	/// instead of being followed out of the vector or around a cycle.
+	/// </summary>
+	/// <param name="file">The file, open for reading in binary mode.</param>
+	/// <returns>True if a whole tree was read, the tree being left empty otherwise.</returns>
+	bool load(std::FILE* file) {
+		static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable data can be loaded as it is");
+		clear();
+		uint32_t header[4];
+		if (std::fread(header, sizeof header, 1, file) != 1)
+			return false;
+		uint32_t root = header[0], free = header[1], size = header[2], slots = header[3];
+		auto valid = [slots](uint32_t i) { return i == nil || i < slots; };
+		if (!valid(root) || !valid(free) || size > slots || (size == 0) != (root == nil) || (size == slots) != (free == nil))
+			return false;
+		long start = std::ftell(file);
+		if (start >= 0 && std::fseek(file, 0, SEEK_END) == 0) {	// do not allocate for slots the file does not hold
+			long end = std::ftell(file);
+			if (end < start || (unsigned long)(end - start) / sizeof(Slot) < slots || std::fseek(file, start, SEEK_SET) != 0)
+				return false;
+		}
+		nodes_.resize(slots);
+		if (std::fread(nodes_.data(), sizeof(Slot), nodes_.size(), file) != nodes_.size()) {
+			clear();
+			return false;
+		}
+		// Every slot must be reached exactly once, from the root as a node of the tree or from the free list,
+		// or a later traversal could loop forever
+		std::vector<bool> reached(slots);
+		uint64_t nodes = 0, freeSlots = 0;
+		std::vector<uint32_t> stack;
+		if (root != nil)
+			stack.push_back(root);
+		bool ok = true;
+		while (ok && !stack.empty()) {
+			uint32_t i = stack.back();
+			stack.pop_back();
+			Slot& s = nodes_[i];
+			ok = !reached[i] && valid(s.leftChild) && valid(s.rightChild) && ++nodes <= size;
+			reached[i] = true;
+			if (s.leftChild != nil)
+				stack.push_back(s.leftChild);
+			if (s.rightChild != nil)
+				stack.push_back(s.rightChild);
+		}
+		for (uint32_t i = free; ok && i != nil; i = nodes_[i].leftChild) {
+			ok = !reached[i] && valid(nodes_[i].leftChild);
+			reached[i] = true;
+			freeSlots++;
+		}
+		if (!ok || nodes != size || freeSlots != slots - size) {
+			clear();
+			return false;
+		}
+		root_ = root;
+		free_ = free;
+		size_ = size;
+		return true;
+	}
+};
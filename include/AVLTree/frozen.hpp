@@ -0,0 +1,227 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "../stats/memory_accounting.hpp"
+
+template <class T, MemoryTag Tag = MemoryTag::Other>
+/// <summary>
+/// Defines an immutable ordered array, the read-only form of an AVL Tree made by AVLTree::freeze(). The elements
+/// are stored in the Eytzinger (breadth first) order of a complete binary search tree: the children of the element
+/// at index k are at 2k and 2k + 1. No links are stored at all, the first levels of every search share a few cache
+/// lines, and the levels further down are prefetched before the search gets to them.
+/// </summary>
+/// <typeparam name="T">A template class.</typeparam>
+/// <typeparam name="Tag">The data structure the memory of the array is accounted to.</typeparam>
+class FrozenTree {
+	/// <summary>
+	/// The elements in Eytzinger order from index 1, index 0 is not used.
+	/// </summary>
+	std::vector<T, TaggedAllocator<T, Tag>> data_;
+	/// <summary>
+	/// Number of elements.
+	/// </summary>
+	size_t size_;
+
+	/// <summary>
+	/// Function to round a number down to a power of 2.
+	/// </summary>
+	static constexpr size_t floorPow2(size_t n) {
+		return n < 2 ? 1 : 2 * floorPow2(n / 2);
+	}
+
+	/// <summary>
+	/// Number of descendants of an element on the level the search prefetches, at indices [k * prefetchBlock,
+	/// (k + 1) * prefetchBlock): as many as fit in two cache lines, so the prefetch is issued a few levels early.
+	/// </summary>
+	static constexpr size_t prefetchBlock = floorPow2(sizeof(T) >= 64 ? 2 : 128 / sizeof(T));
+
+	/// <summary>
+	/// Function to fill the subtree rooted at index k with the next elements of an ordered sequence.
+	/// </summary>
+	template <class Next>
+	void fill(size_t k, Next& next) {
+		if (k > size_)
+			return;
+		fill(2 * k, next);
+		next(data_[k]);
+		fill(2 * k + 1, next);
+	}
+
+	/// <summary>
+	/// Function to descend the array like a binary search tree, going right past the elements less than val.
+	/// </summary>
+	/// <param name="val">The element searched for.</param>
+	/// <returns>The index of the first element not less than val, 0 if there is none.</returns>
+	size_t descend(T& val) {
+		size_t k = 1;
+		while (k <= size_) {
+			const char* block = (const char*)(data_.data() + std::min(k * prefetchBlock, size_));
+			for (size_t line = 0; line < prefetchBlock * sizeof(T); line += 64)
+				__builtin_prefetch(block + line);
+			k = 2 * k + (data_[k] < val);
+		}
+		// k went past a leaf, its bits are the turns taken; shifting out the right turns at the end and the left
+		// turn before them gives the last element the search went left at, the first one not less than val
+		return k >> __builtin_ffsll(~k);
+	}
+
+	/// <summary>
+	/// Function to find the index of the element following the one at index k in the order.
+	/// </summary>
+	/// <returns>The index, 0 after the last element.</returns>
+	size_t successor(size_t k) const {
+		if (2 * k + 1 <= size_) {
+			k = 2 * k + 1;
+			while (2 * k <= size_)
+				k = 2 * k;
+			return k;
+		}
+		return k >> __builtin_ffsll(~k);
+	}
+
+public:
+
+	/// <summary>
+	/// Position of an element in the order of the array.
+	/// </summary>
+	class Iterator {
+		FrozenTree* tree;
+		size_t k;
+		friend class FrozenTree;
+
+	public:
+		Iterator(FrozenTree* tree = nullptr, size_t k = 0) {
+			this->tree = tree;
+			this->k = k;
+		}
+
+		/// <summary>
+		/// Function to check if the iterator points to an element.
+		/// </summary>
+		bool valid() const {
+			return k != 0;
+		}
+
+		T& operator*() const {
+			return tree->data_[k];
+		}
+
+		T* operator->() const {
+			return &tree->data_[k];
+		}
+
+		/// <summary>
+		/// Function to move to the next element, the iterator becomes invalid after the last one.
+		/// </summary>
+		Iterator& operator++() {
+			k = tree->successor(k);
+			return *this;
+		}
+	};
+
+	FrozenTree() {
+		size_ = 0;
+	}
+
+	/// <summary>
+	/// Constructor to initialize the array from an ordered sequence of n elements.
+	/// </summary>
+	/// <param name="n">Number of elements.</param>
+	/// <param name="next">Function moving the next element of the sequence into the reference it is given.</param>
+	template <class Next>
+	FrozenTree(size_t n, Next next) {
+		size_ = n;
+		data_.resize(n ? n + 1 : 0);
+		fill(1, next);
+	}
+
+	/// <summary>
+	/// Constructor to initialize the array from a sorted range, whose elements are moved.
+	/// </summary>
+	/// <param name="first">Iterator to the first element of the range.</param>
+	/// <param name="last">Iterator past the last element of the range.</param>
+	template <class It>
+	FrozenTree(It first, It last) : FrozenTree((size_t)std::distance(first, last), [&first](T& slot) { slot = std::move(*first++); }) {}
+
+	/// <summary>
+	/// Function to search the array.
+	/// </summary>
+	/// <param name="val">The element.</param>
+	/// <returns>The pointer to the element == val, NULL if there is none.</returns>
+	T* search(T val) {
+		return search(val, [](T&) { return true; });
+	}
+
+	/// <summary>
+	/// Function to search the array, skipping the elements the caller has marked as removed.
+	/// </summary>
+	/// <param name="val">The element.</param>
+	/// <param name="live">Function telling if an element is still in the set.</param>
+	/// <returns>The pointer to the live element == val, NULL if there is none.</returns>
+	template <class Live>
+	T* search(T val, Live live) {
+		// Like AVLTree::search, the first element == val on the path of lowerBound is taken
+		size_t k = 1;
+		while (k <= size_) {
+			const char* block = (const char*)(data_.data() + std::min(k * prefetchBlock, size_));
+			for (size_t line = 0; line < prefetchBlock * sizeof(T); line += 64)
+				__builtin_prefetch(block + line);
+			if (data_[k] == val && live(data_[k]))
+				return &data_[k];
+			k = 2 * k + (data_[k] < val);
+		}
+		return nullptr;
+	}
+
+	/// <summary>
+	/// Function to find the first element not less than val.
+	/// </summary>
+	/// <returns>An iterator to the element, invalid if all the elements are less than val.</returns>
+	Iterator lowerBound(T val) {
+		return Iterator(this, descend(val));
+	}
+
+	/// <summary>
+	/// Function to get an iterator to the smallest element.
+	/// </summary>
+	Iterator begin() {
+		if (size_ == 0)
+			return Iterator(this, 0);
+		size_t k = 1;
+		while (2 * k <= size_)
+			k = 2 * k;
+		return Iterator(this, k);
+	}
+
+	/// <summary>
+	/// Function to check if the array is empty.
+	/// </summary>
+	bool empty() {
+		return size_ == 0;
+	}
+
+	/// <summary>
+	/// Function to get the number of elements in the array.
+	/// </summary>
+	size_t size() {
+		return size_;
+	}
+
+	/// <summary>
+	/// Function to get the number of bytes held by the array.
+	/// </summary>
+	size_t bytes() {
+		return data_.capacity() * sizeof(T);
+	}
+
+	/// <summary>
+	/// Function to delete all the elements in the array.
+	/// </summary>
+	void clear() {
+		std::vector<T, TaggedAllocator<T, Tag>>().swap(data_);
+		size_ = 0;
+	}
+};
@@ -1,3 +1,5 @@
+#include <cstddef>
+
 template <class T>
 /// <summary>
 /// Defines the structure of an AVL Tree Node.
@@ -17,6 +19,14 @@ public:
 	/// Pointer to the rightChild child of the node.
 	/// </summary>
 	Node* rightChild;
+	/// <summary>
+	/// Number of nodes on the longest path from the node down to a leaf, 1 for a leaf.
+	/// </summary>
+	int height;
+	/// <summary>
+	/// Number of nodes in the subtree of the node.
+	/// </summary>
+	size_t count;
 
 	/// <summary>
 	/// Constructor to initialize the AVL Tree Node.
@@ -26,5 +36,7 @@ public:
 		this->data = value;
 		this->leftChild = nullptr;
 		this->rightChild = nullptr;
+		this->height = 1;
+		this->count = 1;
 	}
 };
\ No newline at end of file
@@ -1,18 +1,51 @@
 #pragma once 
 
+#include <algorithm>
+#include <iterator>
+#include <new>
+#include <thread>
+
 #include "node.hpp"
+#include "frozen.hpp"
+#include "../stats/counters.hpp"
+#include "../stats/memory_accounting.hpp"
 
-template <class T>
+template <class T, MemoryTag Tag = MemoryTag::Other>
 /// <summary>
 /// Defines the structure of the AVL Tree.
 /// </summary>
 /// <typeparam name="T">A template class.</typeparam>
+/// <typeparam name="Tag">The data structure the memory of the nodes is accounted to.</typeparam>
 class AVLTree {
 	/// <summary>
 	/// Points to the root node of the AVL Tree.
 	/// </summary>
 	Node<T>* root_;
 
+	/// <summary>
+	/// Allocator of the nodes.
+	/// </summary>
+	TaggedAllocator<Node<T>, Tag> allocator;
+
+	/// <summary>
+	/// Function to allocate a new node.
+	/// </summary>
+	/// <param name="val">The data of the node.</param>
+	/// <returns>A pointer to the node.</returns>
+	Node<T>* newNode(T& val) {
+		Node<T>* node = allocator.allocate(1);
+		return new (node) Node<T>(val);
+	}
+
+	/// <summary>
+	/// Function to free a node.
+	/// </summary>
+	/// <param name="node">Pointer to the node.</param>
+	void deleteNode(Node<T>* node) {
+		node->~Node<T>();
+		allocator.deallocate(node, 1);
+	}
+
 	/// <summary>
 	/// Function to insert a node into the AVL Tree.
 	/// </summary>
@@ -24,13 +57,14 @@ class AVLTree {
 		// Normal BST insertion
 
 		if (root == nullptr)
-			root = new Node<T>(val);
+			return newNode(val);
 		else if (val == root->data)
 			return root;
 		else if (val < root->data)
 			root->leftChild = insertNode(root->leftChild, val);
 		else
 			root->rightChild = insertNode(root->rightChild, val);
+		update(root);
 
 		//To check if the node is unbalanced we use the balance factor of the ancestor 
 		// 4 Cases if the node becomes unbalanced 
@@ -68,18 +102,32 @@ class AVLTree {
 	}
 	
 	/// <summary>
-	/// Function to calculate the height of a node in the AVL Tree.
+	/// Function to get the height of a node in the AVL Tree.
 	/// </summary>
 	/// <param name="root">Pointer to the node in the AVL Tree.</param>
-	/// <returns>The height of the node in the AVL Tree.</returns>
+	/// <returns>The height of the node in the AVL Tree, 0 for an empty subtree.</returns>
 	int height(Node<T>* root) {
-		int h = 0;
-		if (root) {		// if root is not NULL then add the maximum of leftChild and rightChild subtree heights and add 1 to it to find the height
-			int left = height(root->leftChild);
-			int right = height(root->rightChild);
-			h = 1 + ((left > right) ? left : right);
-		}
-		return h;
+		return root ? root->height : 0;
+	}
+
+	/// <summary>
+	/// Function to get the number of nodes in a subtree.
+	/// </summary>
+	/// <param name="root">Pointer to the root node of the subtree.</param>
+	/// <returns>The number of nodes, 0 for an empty subtree.</returns>
+	size_t count(Node<T>* root) {
+		return root ? root->count : 0;
+	}
+
+	/// <summary>
+	/// Function to recompute the height and the number of nodes of a node from its children.
+	/// </summary>
+	/// <param name="root">Pointer to the node in the AVL Tree.</param>
+	void update(Node<T>* root) {
+		int left = height(root->leftChild);
+		int right = height(root->rightChild);
+		root->height = 1 + ((left > right) ? left : right);
+		root->count = 1 + count(root->leftChild) + count(root->rightChild);
 	}
 
 	/// <summary>
@@ -88,9 +136,13 @@ class AVLTree {
 	/// <param name="root">Pointer to the node of the AVL Tree.</param>
 	/// <returns>The new root node at the point of rotation in the AVL Tree.</returns>
 	Node<T>* RR(Node<T>* root) {
+		if (countersOn)
+			counters().rotations++;
 		Node<T>* l = root->leftChild;
 		root->leftChild = l->rightChild;	// performing the rotation
 		l->rightChild = root;
+		update(root);
+		update(l);
 		return l;	// return the new root
 	}
 	
@@ -101,23 +153,33 @@ class AVLTree {
 	/// <returns>The new root node at the point of rotation in the AVL Tree.</returns>
 	Node<T>* LR(Node<T>* root)
 	{
+		if (countersOn)
+			counters().rotations++;
 		Node<T>* r = root->rightChild;
 		root->rightChild = r->leftChild;	// performing the rotation
 		r->leftChild = root;
+		update(root);
+		update(r);
 		return r;	// return the new root
 	}
 
 	/// <summary>
-	/// Function to find the maximum element in the AVL Tree.
+	/// Function to unlink the maximum node of a subtree by walking down its right edge.
 	/// </summary>
-	/// <param name="root">The root node of the AVL Tree.</param>
-	/// <returns>The pointer to the maximum valued node in the AVL Tree.</returns>
-	Node<T>* findMax(Node<T>* root)
+	/// <param name="root">The root node of the subtree.</param>
+	/// <param name="max">Variable which will be changed to the unlinked node.</param>
+	/// <returns>The root node of the rest of the subtree.</returns>
+	Node<T>* detachMax(Node<T>* root, Node<T>*& max)
 	{
-		if (root->rightChild == nullptr)	// If the rightChild end of the tree is reached return the maximum
-			return root;
-		else			// else keep traversing till the bottom rightChild end of the tree
-			return findMax(root->rightChild);
+		if (root->rightChild == nullptr) {	// If the rightChild end of the tree is reached this is the maximum
+			max = root;
+			Node<T>* sub_left_tree = root->leftChild;
+			root->leftChild = nullptr;
+			update(root);
+			return sub_left_tree;
+		}
+		root->rightChild = detachMax(root->rightChild, max);
+		return rebalance(root);
 	}
 
 	/// <summary>
@@ -137,31 +199,60 @@ class AVLTree {
 			root->rightChild = removeNode(root->rightChild, val);
 		else {		// If the data to be removed is equal to the current root's data delete the node
 			if (root->leftChild == nullptr && root->rightChild == nullptr) { // if the node to be removed is a leaf node
-				delete root;
+				deleteNode(root);
 				return nullptr;
 			}
 			else if (root->leftChild == nullptr && root->rightChild != nullptr) {
 				Node<T>* sub_right_tree = root->rightChild;   // Copying the rightChild subtree before deleting the current node
-				delete root;
+				deleteNode(root);
 				return sub_right_tree;		// Return the pointer to the rightChild subtree
 			}
 			else if (root->leftChild != nullptr && root->rightChild == nullptr) {
 				Node<T>* sub_left_tree = root->leftChild;  // Copying the leftChild subtree before deleting the current node
-				delete root;
+				deleteNode(root);
 				return sub_left_tree;		// Return the pointer to the leftChild subtree
 			}
-			else			// if the node has both leftChild and rightChild subtrees find the maximum valued node in the leftChild subtree
-						// and recursively call the removeNode function over leftChild subtree and data to be removed as the maximum of the leftChild subtree node
+			else			// if the node has both leftChild and rightChild subtrees replace its data with the maximum of the leftChild subtree
+						// and unlink that node, structurally rather than by searching for its data
 			{
-				Node<T>* maxium_node_in_sub_left_tree = findMax(root->leftChild);
+				Node<T>* maxium_node_in_sub_left_tree;
+				root->leftChild = detachMax(root->leftChild, maxium_node_in_sub_left_tree);
 				root->data = maxium_node_in_sub_left_tree->data;
-				root->leftChild = removeNode(root->leftChild, maxium_node_in_sub_left_tree->data);
+				deleteNode(maxium_node_in_sub_left_tree);
 			}
 		}
+		return rebalance(root);
+	}
+
+	/// <summary>
+	/// Function to remove the leftmost node of the AVL Tree by walking down its left edge, without comparing any data.
+	/// The fuzzy comparisons of the points are not transitive, so a search for the minimum may not find it.
+	/// </summary>
+	/// <param name="root">The root node of the AVL Tree.</param>
+	/// <returns>The pointer to the new node at the deleted position in the AVL Tree.</returns>
+	Node<T>* removeLeftmost(Node<T>* root)
+	{
+		if (root->leftChild == nullptr) {
+			Node<T>* sub_right_tree = root->rightChild;
+			deleteNode(root);
+			return sub_right_tree;
+		}
+		root->leftChild = removeLeftmost(root->leftChild);
+		return rebalance(root);
+	}
+
+	/// <summary>
+	/// Function to restore the balance of a node after a deletion or a join below it.
+	/// </summary>
+	/// <param name="root">The node.</param>
+	/// <returns>The pointer to the node now at its position.</returns>
+	Node<T>* rebalance(Node<T>* root)
+	{
+		update(root);
 		// Deletion may disturb the balance factor of the tree
 		// To rebalance the tree perform leftChild or rightChild rotation
 		if (balanceFactor(root) > 1) {
-			if (height(root->leftChild->leftChild) > height(root->leftChild->rightChild)) {
+			if (height(root->leftChild->leftChild) >= height(root->leftChild->rightChild)) {
 				root = RR(root);
 			}
 			else {
@@ -209,19 +300,237 @@ class AVLTree {
 		// recurvisely call and clear the leftChild and rightChild subtrees
 		clearTree(root->leftChild);
 		clearTree(root->rightChild);
-		delete root; // then delete the current node after clear the subtrees
+		deleteNode(root); // then delete the current node after clear the subtrees
 	}
 
 	/// <summary>
-	/// Function to remove the elements of one AVL Tree from another.
+	/// Function to build a perfectly balanced subtree from a sorted range, the middle element becoming its root.
 	/// </summary>
-	/// <param name="node">The root node of the second AVL Tree.</param>
-	void diff(Node<T>* node) {
-		if (node == nullptr)
-			return;
-		remove(node->data);
-		diff(node->leftChild);
-		diff(node->rightChild);
+	/// <param name="first">Iterator to the first element of the range.</param>
+	/// <param name="last">Iterator past the last element of the range.</param>
+	/// <param name="threads">Number of threads the subtree may be built on.</param>
+	/// <returns>The root node of the subtree.</returns>
+	template <class It>
+	Node<T>* buildRange(It first, It last, unsigned threads) {
+		if (first == last)
+			return nullptr;
+
+		It middle = first + (last - first) / 2;
+		Node<T>* root = newNode(*middle);
+
+		// Below a few thousand nodes a thread costs more than it saves
+		if (threads > 1 && last - first > 4096) {
+			std::thread left([&] { root->leftChild = buildRange(first, middle, threads / 2); });
+			root->rightChild = buildRange(middle + 1, last, threads - threads / 2);
+			left.join();
+		}
+		else {
+			root->leftChild = buildRange(first, middle, 1);
+			root->rightChild = buildRange(middle + 1, last, 1);
+		}
+		update(root);
+		return root;
+	}
+
+	/// <summary>
+	/// Function to join two subtrees and a node between them, every element of the left subtree being smaller
+	/// than the node and every element of the right one greater. The node goes down the spine of the taller
+	/// subtree to where the heights match, so the join takes O(|height(left) - height(right)| + 1).
+	/// </summary>
+	/// <param name="left">The root node of the left subtree.</param>
+	/// <param name="middle">The node between them, unlinked from any tree.</param>
+	/// <param name="right">The root node of the right subtree.</param>
+	/// <returns>The root node of the joined tree.</returns>
+	Node<T>* joinNodes(Node<T>* left, Node<T>* middle, Node<T>* right) {
+		if (height(left) > height(right) + 1) {
+			left->rightChild = joinNodes(left->rightChild, middle, right);
+			return rebalance(left);
+		}
+		if (height(right) > height(left) + 1) {
+			right->leftChild = joinNodes(left, middle, right->leftChild);
+			return rebalance(right);
+		}
+		middle->leftChild = left;
+		middle->rightChild = right;
+		update(middle);
+		return middle;
+	}
+
+	/// <summary>
+	/// Function to join two subtrees, every element of the left one being smaller than every element of the right one.
+	/// </summary>
+	/// <returns>The root node of the joined tree.</returns>
+	Node<T>* joinNodes(Node<T>* left, Node<T>* right) {
+		if (left == nullptr)
+			return right;
+		Node<T>* max;
+		left = detachMax(left, max);
+		return joinNodes(left, max, right);
+	}
+
+	/// <summary>
+	/// Function to split a subtree around a key, locating the key the way insertNode places it.
+	/// </summary>
+	/// <param name="root">The root node of the subtree, which is taken apart.</param>
+	/// <param name="key">The key.</param>
+	/// <param name="left">Variable which will be changed to the root node of the elements before the key.</param>
+	/// <param name="right">Variable which will be changed to the root node of the elements after the key.</param>
+	/// <returns>The unlinked node equal to the key, NULL if there is none.</returns>
+	Node<T>* splitNode(Node<T>* root, T& key, Node<T>*& left, Node<T>*& right) {
+		if (root == nullptr) {
+			left = right = nullptr;
+			return nullptr;
+		}
+		Node<T>* l = root->leftChild;
+		Node<T>* r = root->rightChild;
+		root->leftChild = root->rightChild = nullptr;
+
+		if (key == root->data) {
+			left = l;
+			right = r;
+			update(root);
+			return root;
+		}
+		Node<T>* found;
+		if (key < root->data) {
+			found = splitNode(l, key, left, l);
+			right = joinNodes(l, root, r);
+		}
+		else {
+			found = splitNode(r, key, r, right);
+			left = joinNodes(l, root, r);
+		}
+		return found;
+	}
+
+	/// <summary>
+	/// Minimum number of nodes for which the set operations hand a subtree to another thread.
+	/// </summary>
+	static const size_t parallelGrain = 4096;
+
+	/// <summary>
+	/// Function to run the set operation on the two halves of a split, on two threads when they are large enough.
+	/// </summary>
+	template <class L, class R>
+	void forkJoin(size_t n, unsigned threads, L& left, R& right) {
+		if (threads > 1 && n > parallelGrain) {
+			std::thread t([&] { left(threads / 2); });
+			right(threads - threads / 2);
+			t.join();
+		}
+		else {
+			left(1);
+			right(1);
+		}
+	}
+
+	/// <summary>
+	/// Function to merge two subtrees into one, freeing the nodes of the second one which equal an element of the first.
+	/// </summary>
+	/// <returns>The root node of the union.</returns>
+	Node<T>* unionNodes(Node<T>* a, Node<T>* b, unsigned threads) {
+		if (a == nullptr)
+			return b;
+		if (b == nullptr)
+			return a;
+
+		Node<T>* bl;
+		Node<T>* br;
+		Node<T>* duplicate = splitNode(b, a->data, bl, br);
+		if (duplicate)
+			deleteNode(duplicate);
+
+		Node<T>* l = a->leftChild;
+		Node<T>* r = a->rightChild;
+		auto left = [&](unsigned t) { l = unionNodes(l, bl, t); };
+		auto right = [&](unsigned t) { r = unionNodes(r, br, t); };
+		forkJoin(a->count + count(bl) + count(br), threads, left, right);
+		return joinNodes(l, a, r);
+	}
+
+	/// <summary>
+	/// Function to free the nodes of a subtree which equal an element of a second subtree, leaving the second one unchanged.
+	/// </summary>
+	/// <returns>The root node of the difference.</returns>
+	Node<T>* differenceNodes(Node<T>* a, Node<T>* b, unsigned threads) {
+		if (a == nullptr || b == nullptr)
+			return a;
+
+		Node<T>* l;
+		Node<T>* r;
+		Node<T>* found = splitNode(a, b->data, l, r);
+		if (found)
+			deleteNode(found);
+
+		auto left = [&](unsigned t) { l = differenceNodes(l, b->leftChild, t); };
+		auto right = [&](unsigned t) { r = differenceNodes(r, b->rightChild, t); };
+		forkJoin(count(l) + count(r) + b->count, threads, left, right);
+		return joinNodes(l, r);
+	}
+
+	/// <summary>
+	/// Function to free the nodes of a subtree which equal no element of a second subtree, leaving the second one unchanged.
+	/// </summary>
+	/// <returns>The root node of the intersection.</returns>
+	Node<T>* intersectionNodes(Node<T>* a, Node<T>* b, unsigned threads) {
+		if (a == nullptr)
+			return nullptr;
+		if (b == nullptr) {
+			clearTree(a);
+			return nullptr;
+		}
+
+		Node<T>* l;
+		Node<T>* r;
+		Node<T>* found = splitNode(a, b->data, l, r);
+
+		auto left = [&](unsigned t) { l = intersectionNodes(l, b->leftChild, t); };
+		auto right = [&](unsigned t) { r = intersectionNodes(r, b->rightChild, t); };
+		forkJoin(count(l) + count(r) + b->count, threads, left, right);
+		return found ? joinNodes(l, found, r) : joinNodes(l, r);
+	}
+
+	/// <summary>
+	/// Function to merge a sorted range into a subtree, the middle of the range playing the part of the root of
+	/// the second subtree of unionNodes.
+	/// </summary>
+	/// <returns>The root node of the union.</returns>
+	template <class It>
+	Node<T>* unionRange(Node<T>* a, It first, It last) {
+		if (first == last)
+			return a;
+
+		It middle = first + (last - first) / 2;
+		Node<T>* l;
+		Node<T>* r;
+		Node<T>* found = splitNode(a, *middle, l, r);
+		if (!found)
+			found = newNode(*middle);
+
+		l = unionRange(l, first, middle);
+		r = unionRange(r, middle + 1, last);
+		return joinNodes(l, found, r);
+	}
+
+	/// <summary>
+	/// Function to free the nodes of a subtree which equal an element of a sorted range.
+	/// </summary>
+	/// <returns>The root node of the difference.</returns>
+	template <class It>
+	Node<T>* differenceRange(Node<T>* a, It first, It last) {
+		if (a == nullptr || first == last)
+			return a;
+
+		It middle = first + (last - first) / 2;
+		Node<T>* l;
+		Node<T>* r;
+		Node<T>* found = splitNode(a, *middle, l, r);
+		if (found)
+			deleteNode(found);
+
+		l = differenceRange(l, first, middle);
+		r = differenceRange(r, middle + 1, last);
+		return joinNodes(l, r);
 	}
 
 	/// <summary>
@@ -269,7 +578,13 @@ class AVLTree {
 	// remove()- to remove a node with data provided to the function
 	// display()- to print the inorder traversal of the tree
 	//clear()- to delete the entire tree
-	//difference()- 
+	//size()- to get the number of nodes in the tree
+	//treeHeight()- to get the height of the tree
+	//split()- to move the elements from a key onwards into another tree
+	//join()- to append the elements of another tree
+	//unionWith()- to move the elements of another tree into the tree
+	//difference()- to remove the elements of another tree
+	//intersection()- to keep only the elements of another tree
 	//search()- to find if a given data is in the tree or not
 public:
 
@@ -306,6 +621,42 @@ public:
 		root_ = removeNode(root_, val);
 	}
 
+	/// <summary>
+	/// Function to replace the contents of the AVL Tree with a sorted range in O(n), without any comparison
+	/// or rotation. The heights of the two subtrees of every node differ by at most one.
+	/// </summary>
+	/// <param name="first">Random access iterator to the first element of the range.</param>
+	/// <param name="last">Random access iterator past the last element of the range.</param>
+	/// <remarks>The range must be sorted in the order of the tree and hold no equal elements.</remarks>
+	template <class It>
+	void build(It first, It last) {
+		buildParallel(first, last, 1);
+	}
+
+	/// <summary>
+	/// Function to replace the contents of the AVL Tree with a sorted range, building the subtrees near the root
+	/// on separate threads.
+	/// </summary>
+	/// <param name="first">Random access iterator to the first element of the range.</param>
+	/// <param name="last">Random access iterator past the last element of the range.</param>
+	/// <param name="threads">Number of threads, 0 for one per hardware thread.</param>
+	template <class It>
+	void buildParallel(It first, It last, unsigned threads) {
+		if (threads == 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		clear();
+		root_ = buildRange(first, last, threads);
+	}
+
+	/// <summary>
+	/// Function to remove the smallest node of the AVL Tree.
+	/// </summary>
+	void removeMin()
+	{
+		if (root_)
+			root_ = removeLeftmost(root_);
+	}
+
 	/// <summary>
 	/// Function to print the AVL Tree.
 	/// </summary>
@@ -324,11 +675,121 @@ public:
 	}
 
 	/// <summary>
-	/// Helper function to delete the elements of one AVL Tree from another.
+	/// Function to get the number of nodes in the AVL Tree.
+	/// </summary>
+	/// <returns>The number of nodes in the AVL Tree.</returns>
+	size_t size() {
+		return count(root_);
+	}
+
+	/// <summary>
+	/// Function to get the height of the AVL Tree.
+	/// </summary>
+	/// <returns>The number of nodes on the longest path from the root to a leaf.</returns>
+	int treeHeight() {
+		return height(root_);
+	}
+
+	/// <summary>
+	/// Function to split the AVL Tree at a key in O(log n): the elements before the key stay, the key and the
+	/// elements after it move into another tree.
+	/// </summary>
+	/// <param name="key">The key.</param>
+	/// <param name="right">The AVL Tree which will be changed to the key and the elements after it.</param>
+	void split(T key, AVLTree<T, Tag>& right) {
+		right.clear();
+		Node<T>* found = splitNode(root_, key, root_, right.root_);
+		if (found)
+			right.root_ = joinNodes(nullptr, found, right.root_);
+	}
+
+	/// <summary>
+	/// Function to append the elements of another AVL Tree in O(log n), all of them being greater than the
+	/// elements of this one. The other tree is left empty.
+	/// </summary>
+	/// <param name="right">The AVL Tree whose elements are appended.</param>
+	void join(AVLTree<T, Tag>& right) {
+		root_ = joinNodes(root_, right.root_);
+		right.root_ = nullptr;
+	}
+
+	/// <summary>
+	/// Function to move the elements of another AVL Tree into this one, in O(m log(n / m + 1)) for m elements
+	/// in the smaller tree. Elements equal to one already in this tree are dropped and the other tree is left empty.
+	/// </summary>
+	/// <param name="t">The other AVL Tree.</param>
+	/// <param name="threads">Number of threads, 0 for one per hardware thread.</param>
+	void unionWith(AVLTree<T, Tag>& t, unsigned threads = 1) {
+		if (threads == 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		root_ = unionNodes(root_, t.root_, threads);
+		t.root_ = nullptr;
+	}
+
+	/// <summary>
+	/// Function to delete the elements of another AVL Tree from this one, in O(m log(n / m + 1)).
 	/// </summary>
 	/// <param name="t">The other AVL Tree, whose elements must be removed from the current one.</param>
-	void difference(AVLTree<T>& t) {
-		diff(t.getRoot());
+	/// <param name="threads">Number of threads, 0 for one per hardware thread.</param>
+	void difference(AVLTree<T, Tag>& t, unsigned threads = 1) {
+		if (threads == 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		root_ = differenceNodes(root_, t.root_, threads);
+	}
+
+	/// <summary>
+	/// Function to delete the elements of this AVL Tree which are not in another one, in O(m log(n / m + 1)).
+	/// </summary>
+	/// <param name="t">The other AVL Tree.</param>
+	/// <param name="threads">Number of threads, 0 for one per hardware thread.</param>
+	void intersection(AVLTree<T, Tag>& t, unsigned threads = 1) {
+		if (threads == 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		root_ = intersectionNodes(root_, t.root_, threads);
+	}
+
+	/// <summary>
+	/// Function to insert a sorted range of distinct elements, in O(m log(n / m + 1)) like unionWith but without
+	/// building a tree of them first. Elements equal to one already in the tree are skipped.
+	/// </summary>
+	/// <param name="first">Random access iterator to the first element.</param>
+	/// <param name="last">Random access iterator past the last element.</param>
+	template <class It>
+	void unionWith(It first, It last) {
+		root_ = unionRange(root_, first, last);
+	}
+
+	/// <summary>
+	/// Function to delete the elements of a sorted range of distinct elements, in O(m log(n / m + 1)).
+	/// </summary>
+	/// <param name="first">Random access iterator to the first element.</param>
+	/// <param name="last">Random access iterator past the last element.</param>
+	template <class It>
+	void difference(It first, It last) {
+		root_ = differenceRange(root_, first, last);
+	}
+
+	/// <summary>
+	/// Function to move the elements of the AVL Tree into an immutable array searched in O(log n), for a tree
+	/// which is only searched from now on. The array holds the elements without any links, half the memory of
+	/// the nodes or less, and the AVL Tree is left empty.
+	/// </summary>
+	/// <returns>The array.</returns>
+	FrozenTree<T, Tag> freeze() {
+		// In order traversal with a stack of the nodes whose left subtree is being visited
+		std::vector<Node<T>*> path;
+		Node<T>* node = root_;
+		auto next = [&](T& slot) {
+			for (; node; node = node->leftChild)
+				path.push_back(node);
+			node = path.back();
+			path.pop_back();
+			slot = std::move(node->data);
+			node = node->rightChild;
+		};
+		FrozenTree<T, Tag> frozen(size(), next);
+		clear();
+		return frozen;
 	}
 
 	/// <summary>
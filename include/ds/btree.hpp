@@ -0,0 +1,540 @@
+#pragma once
+
+#include <cstddef>
+
+template <class T, int B = 32>
+/// <summary>
+/// Defines the structure of a B+ Tree. The elements are kept in sorted arrays of up to B elements in the
+/// leaves, which are linked in order; the inner nodes hold up to B children and the smallest element under
+/// every child but the first. Like the AVL Tree it orders the elements with the operators of T and treats
+/// elements which are == as duplicates.
+/// </summary>
+/// <typeparam name="T">A template class.</typeparam>
+/// <typeparam name="B">Maximum number of elements in a leaf and children of an inner node.</typeparam>
+class BTree {
+	static_assert(B >= 4, "a node must hold at least 4 entries");
+
+	/// <summary>
+	/// Node of the B+ Tree.
+	/// </summary>
+	struct BNode {
+		bool leaf;
+		/// <summary>
+		/// Number of elements in a leaf, number of children of an inner node.
+		/// </summary>
+		int count;
+		/// <summary>
+		/// Elements of a leaf; keys[i - 1] is the smallest element under children[i] in an inner node.
+		/// </summary>
+		T keys[B];
+		BNode* children[B];
+		/// <summary>
+		/// Neighbouring leaves.
+		/// </summary>
+		BNode* prev;
+		BNode* next;
+
+		BNode(bool leaf) {
+			this->leaf = leaf;
+			count = 0;
+			prev = next = nullptr;
+		}
+	};
+
+public:
+
+	/// <summary>
+	/// Position of an element in the leaves of the B+ Tree.
+	/// </summary>
+	class Iterator {
+		BNode* node;
+		int pos;
+		friend class BTree;
+
+	public:
+		Iterator(BNode* node = nullptr, int pos = 0) {
+			this->node = node;
+			this->pos = pos;
+		}
+
+		/// <summary>
+		/// Function to check if the iterator points to an element.
+		/// </summary>
+		bool valid() const {
+			return node != nullptr;
+		}
+
+		T& operator*() const {
+			return node->keys[pos];
+		}
+
+		T* operator->() const {
+			return &node->keys[pos];
+		}
+
+		/// <summary>
+		/// Function to move to the next element, the iterator becomes invalid after the last one.
+		/// </summary>
+		Iterator& operator++() {
+			if (++pos == node->count) {
+				node = node->next;
+				pos = 0;
+			}
+			return *this;
+		}
+
+		/// <summary>
+		/// Function to move to the previous element, the iterator becomes invalid before the first one.
+		/// </summary>
+		Iterator& operator--() {
+			if (pos-- == 0) {
+				node = node->prev;
+				pos = node ? node->count - 1 : 0;
+			}
+			return *this;
+		}
+	};
+
+private:
+	/// <summary>
+	/// Points to the root node of the B+ Tree, NULL if the tree is empty.
+	/// </summary>
+	BNode* root_;
+	/// <summary>
+	/// Leftmost and rightmost leaves.
+	/// </summary>
+	BNode* first_;
+	BNode* last_;
+	/// <summary>
+	/// Number of elements in the B+ Tree.
+	/// </summary>
+	size_t size_;
+
+	/// <summary>
+	/// Function to find the child of an inner node whose elements val belongs with.
+	/// </summary>
+	int childIndex(BNode* node, T& val) {
+		int lo = 0, hi = node->count - 1;
+		while (lo < hi) {
+			int mid = (lo + hi) / 2;
+			if (val < node->keys[mid])
+				hi = mid;
+			else
+				lo = mid + 1;
+		}
+		return lo;
+	}
+
+	/// <summary>
+	/// Function to find the position of the first element of a leaf not less than val.
+	/// </summary>
+	int lowerBound(BNode* node, T& val) {
+		int lo = 0, hi = node->count;
+		while (lo < hi) {
+			int mid = (lo + hi) / 2;
+			if (node->keys[mid] < val)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return lo;
+	}
+
+	/// <summary>
+	/// Function to find the position of an element == val in a leaf, around the position pos of the lower bound.
+	/// </summary>
+	/// <returns>The position of the element, -1 if it is not in the leaf.</returns>
+	int matchAt(BNode* node, int pos, T& val) {
+		if (pos < node->count && node->keys[pos] == val)
+			return pos;
+		if (pos > 0 && node->keys[pos - 1] == val)
+			return pos - 1;
+		return -1;
+	}
+
+	/// <summary>
+	/// Function to find the smallest element under a node.
+	/// </summary>
+	T& firstKey(BNode* node) {
+		while (!node->leaf)
+			node = node->children[0];
+		return node->keys[0];
+	}
+
+	/// <summary>
+	/// Function to find the leaf val belongs in.
+	/// </summary>
+	BNode* findLeaf(T& val) {
+		BNode* node = root_;
+		while (!node->leaf)
+			node = node->children[childIndex(node, val)];
+		return node;
+	}
+
+	/// <summary>
+	/// Function to insert an element under a node.
+	/// </summary>
+	/// <param name="node">The node.</param>
+	/// <param name="val">The element.</param>
+	/// <param name="inserted">Variable which will be changed to true if the element was not in the tree.</param>
+	/// <returns>The new right sibling of the node if it was split, NULL if otherwise.</returns>
+	BNode* insertNode(BNode* node, T& val, bool& inserted) {
+		if (node->leaf) {
+			int pos = lowerBound(node, val);
+			if (matchAt(node, pos, val) >= 0 || (pos == 0 && node->prev && node->prev->keys[node->prev->count - 1] == val))
+				return nullptr;
+			inserted = true;
+
+			BNode* right = nullptr;
+			if (node->count == B) {		// split the leaf in halves and link the new one after it
+				right = new BNode(true);
+				int half = B / 2;
+				for (int i = half; i < B; i++)
+					right->keys[i - half] = node->keys[i];
+				right->count = B - half;
+				node->count = half;
+
+				right->next = node->next;
+				right->prev = node;
+				if (node->next)
+					node->next->prev = right;
+				else
+					last_ = right;
+				node->next = right;
+
+				if (pos > half) {
+					node = right;
+					pos -= half;
+				}
+			}
+			for (int i = node->count; i > pos; i--)
+				node->keys[i] = node->keys[i - 1];
+			node->keys[pos] = val;
+			node->count++;
+			return right;
+		}
+
+		int i = childIndex(node, val);
+		BNode* split = insertNode(node->children[i], val, inserted);
+		if (!split)
+			return nullptr;
+
+		// The new child goes right after the one which was split
+		T sep = firstKey(split);
+		if (node->count < B) {
+			for (int j = node->count; j > i + 1; j--) {
+				node->children[j] = node->children[j - 1];
+				node->keys[j - 1] = node->keys[j - 2];
+			}
+			node->children[i + 1] = split;
+			node->keys[i] = sep;
+			node->count++;
+			return nullptr;
+		}
+
+		// Split a full node: of the B + 1 children, the left half keeps (B + 1) / 2 and the rest move to a new node
+		BNode* children[B + 1];
+		T keys[B];
+		for (int j = 0, k = 0; j <= B; j++)
+			children[j] = (j == i + 1) ? split : node->children[k++];
+		for (int j = 0, k = 0; j < B; j++)
+			keys[j] = (j == i) ? sep : node->keys[k++];
+
+		BNode* right = new BNode(false);
+		int keep = (B + 1) / 2;
+		for (int j = 0; j < keep; j++) {
+			node->children[j] = children[j];
+			if (j > 0)
+				node->keys[j - 1] = keys[j - 1];
+		}
+		for (int j = keep; j <= B; j++) {
+			right->children[j - keep] = children[j];
+			if (j > keep)
+				right->keys[j - keep - 1] = keys[j - 1];
+		}
+		node->count = keep;
+		right->count = B + 1 - keep;
+		return right;
+	}
+
+	/// <summary>
+	/// Function to merge or refill the child of an inner node which has less than B / 2 entries left.
+	/// </summary>
+	/// <param name="node">The inner node.</param>
+	/// <param name="i">Index of the child.</param>
+	void rebalance(BNode* node, int i) {
+		BNode* c = node->children[i];
+		BNode* left = i > 0 ? node->children[i - 1] : nullptr;
+		BNode* right = i + 1 < node->count ? node->children[i + 1] : nullptr;
+
+		if (left && left->count > B / 2) {		// borrow the last entry of the left sibling
+			for (int j = c->count; j > 0; j--) {
+				if (c->leaf)
+					c->keys[j] = c->keys[j - 1];
+				else {
+					c->children[j] = c->children[j - 1];
+					if (j > 1)
+						c->keys[j - 1] = c->keys[j - 2];
+				}
+			}
+			if (c->leaf) {
+				c->keys[0] = left->keys[left->count - 1];
+				node->keys[i - 1] = c->keys[0];
+			}
+			else {
+				c->children[0] = left->children[left->count - 1];
+				c->keys[0] = node->keys[i - 1];
+				node->keys[i - 1] = left->keys[left->count - 2];
+			}
+			left->count--;
+			c->count++;
+		}
+		else if (right && right->count > B / 2) {		// borrow the first entry of the right sibling
+			if (c->leaf) {
+				c->keys[c->count] = right->keys[0];
+				for (int j = 1; j < right->count; j++)
+					right->keys[j - 1] = right->keys[j];
+				node->keys[i] = right->keys[0];
+			}
+			else {
+				c->children[c->count] = right->children[0];
+				c->keys[c->count - 1] = node->keys[i];
+				node->keys[i] = right->keys[0];
+				for (int j = 1; j < right->count; j++) {
+					right->children[j - 1] = right->children[j];
+					if (j > 1)
+						right->keys[j - 2] = right->keys[j - 1];
+				}
+			}
+			right->count--;
+			c->count++;
+		}
+		else {		// merge with a sibling, the right one of the pair is deleted
+			if (left) {
+				right = c;
+				c = left;
+				i--;
+			}
+			if (c->leaf) {
+				for (int j = 0; j < right->count; j++)
+					c->keys[c->count + j] = right->keys[j];
+				c->next = right->next;
+				if (right->next)
+					right->next->prev = c;
+				else
+					last_ = c;
+			}
+			else {
+				c->keys[c->count - 1] = node->keys[i];
+				for (int j = 0; j < right->count; j++) {
+					c->children[c->count + j] = right->children[j];
+					if (j > 0)
+						c->keys[c->count + j - 1] = right->keys[j - 1];
+				}
+			}
+			c->count += right->count;
+			delete right;
+
+			for (int j = i + 1; j + 1 < node->count; j++) {
+				node->children[j] = node->children[j + 1];
+				node->keys[j - 1] = node->keys[j];
+			}
+			node->count--;
+		}
+	}
+
+	/// <summary>
+	/// Function to remove an element under a node.
+	/// </summary>
+	/// <param name="node">The node.</param>
+	/// <param name="val">The element.</param>
+	/// <returns>True, if the element was removed; False if it is not in the tree.</returns>
+	bool removeNode(BNode* node, T& val) {
+		if (node->leaf) {
+			int pos = matchAt(node, lowerBound(node, val), val);
+			if (pos < 0)
+				return false;
+			for (int i = pos + 1; i < node->count; i++)
+				node->keys[i - 1] = node->keys[i];
+			node->count--;
+			size_--;
+			return true;
+		}
+
+		int i = childIndex(node, val);
+		bool removed = removeNode(node->children[i], val);
+		if (!removed && i > 0)		// an element == val may sort just before the key of its child
+			removed = removeNode(node->children[--i], val);
+		if (!removed)
+			return false;
+
+		if (i > 0 && node->children[i]->count > 0)		// the smallest element of the child may have been removed
+			node->keys[i - 1] = firstKey(node->children[i]);
+		if (node->children[i]->count < B / 2 && node->count > 1)
+			rebalance(node, i);
+		return true;
+	}
+
+	/// <summary>
+	/// Function to delete all the nodes under a node.
+	/// </summary>
+	void clearTree(BNode* node) {
+		if (node == nullptr)
+			return;
+		if (!node->leaf)
+			for (int i = 0; i < node->count; i++)
+				clearTree(node->children[i]);
+		delete node;
+	}
+
+	/// <summary>
+	/// Function to count the nodes under a node.
+	/// </summary>
+	size_t countNodes(BNode* node) {
+		if (node == nullptr)
+			return 0;
+		size_t n = 1;
+		if (!node->leaf)
+			for (int i = 0; i < node->count; i++)
+				n += countNodes(node->children[i]);
+		return n;
+	}
+
+public:
+
+	/// <summary>
+	/// Constructor to initialize the B+ Tree.
+	/// </summary>
+	BTree() {
+		root_ = first_ = last_ = nullptr;
+		size_ = 0;
+	}
+
+	~BTree() {
+		clear();
+	}
+
+	BTree(const BTree&) = delete;
+	BTree& operator=(const BTree&) = delete;
+
+	/// <summary>
+	/// Function to insert an element into the B+ Tree.
+	/// </summary>
+	/// <param name="val">The element.</param>
+	/// <returns>True, if the element was inserted; False if an element == val was already in the tree.</returns>
+	bool insert(T val) {
+		if (root_ == nullptr)
+			root_ = first_ = last_ = new BNode(true);
+
+		bool inserted = false;
+		BNode* split = insertNode(root_, val, inserted);
+		if (split) {		// grow a new root above the two halves
+			BNode* root = new BNode(false);
+			root->children[0] = root_;
+			root->children[1] = split;
+			root->keys[0] = firstKey(split);
+			root->count = 2;
+			root_ = root;
+		}
+		if (inserted)
+			size_++;
+		return inserted;
+	}
+
+	/// <summary>
+	/// Function to remove an element from the B+ Tree.
+	/// </summary>
+	/// <param name="val">The element.</param>
+	/// <returns>True, if the element was removed; False if it is not in the tree.</returns>
+	bool remove(T val) {
+		if (root_ == nullptr || !removeNode(root_, val))
+			return false;
+
+		if (!root_->leaf && root_->count == 1) {		// shrink the tree when the root has a single child left
+			BNode* old = root_;
+			root_ = root_->children[0];
+			delete old;
+		}
+		else if (root_->leaf && root_->count == 0) {
+			delete root_;
+			root_ = first_ = last_ = nullptr;
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// Function to search the B+ Tree.
+	/// </summary>
+	/// <param name="val">The element.</param>
+	/// <returns>The pointer to the element == val in the tree, NULL if there is none.</returns>
+	T* search(T val) {
+		Iterator it = lowerBound(val);
+		if (it.valid() && *it == val)
+			return &*it;
+		if (it.valid())
+			--it;
+		else
+			it = last();
+		if (it.valid() && *it == val)
+			return &*it;
+		return nullptr;
+	}
+
+	/// <summary>
+	/// Function to find the first element not less than val.
+	/// </summary>
+	/// <returns>An iterator to the element, invalid if all the elements are less than val.</returns>
+	Iterator lowerBound(T val) {
+		if (root_ == nullptr)
+			return Iterator();
+		BNode* leaf = findLeaf(val);
+		int pos = lowerBound(leaf, val);
+		if (pos == leaf->count)
+			return Iterator(leaf->next, 0);
+		return Iterator(leaf, pos);
+	}
+
+	/// <summary>
+	/// Function to get an iterator to the smallest element.
+	/// </summary>
+	Iterator begin() {
+		return Iterator(first_, 0);
+	}
+
+	/// <summary>
+	/// Function to get an iterator to the largest element.
+	/// </summary>
+	Iterator last() {
+		return last_ ? Iterator(last_, last_->count - 1) : Iterator();
+	}
+
+	/// <summary>
+	/// Function to check if the B+ Tree is empty.
+	/// </summary>
+	bool empty() {
+		return size_ == 0;
+	}
+
+	/// <summary>
+	/// Function to get the number of elements in the B+ Tree.
+	/// </summary>
+	size_t size() {
+		return size_;
+	}
+
+	/// <summary>
+	/// Function to get the number of bytes held by the nodes of the B+ Tree.
+	/// </summary>
+	size_t bytes() {
+		return countNodes(root_) * sizeof(BNode);
+	}
+
+	/// <summary>
+	/// Function to delete all the elements in the B+ Tree.
+	/// </summary>
+	void clear() {
+		clearTree(root_);
+		root_ = first_ = last_ = nullptr;
+		size_ = 0;
+	}
+};
@@ -0,0 +1,824 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "../geometry/segment.hpp"
+#include "../stats/counters.hpp"
+#include "../stats/memory_accounting.hpp"
+
+template <int B = 32>
+/// <summary>
+/// Implementation of the Status data structure using a B+ Tree, the alternative to the AVL Tree of Status for large
+/// sweeps where every comparison down the AVL Tree misses the cache. The slopes and intercepts of the line segments
+/// are kept apart from the segments in every node, so a node is searched by computing the positions of all its
+/// keys on the sweep line a few at a time; the leaves are linked to step to the neighbours. It orders the line
+/// segments like Status, by their position at Segment::k, and treats line segments which are == as duplicates.
+/// With the finger on, the searches of the neighbours, the inserts and the removals start from the leaf of the
+/// last search and only climb as far up as the line segment they look for is away from it, as consecutive events
+/// are usually close on the sweep line.
+/// </summary>
+/// <typeparam name="B">Maximum number of line segments in a leaf and children of an inner node.</typeparam>
+class BTreeStatus {
+	static_assert(B >= 8 && B % 4 == 0, "a node must hold a multiple of 4 entries, at least 8");
+
+	/// <summary>
+	/// Part common to the inner nodes and the leaves.
+	/// </summary>
+	struct Inner;
+
+	struct BNode {
+		bool leaf;
+		/// <summary>
+		/// Number of line segments in a leaf, number of children of an inner node.
+		/// </summary>
+		int count;
+		/// <summary>
+		/// Slopes and intercepts of the line segments of a leaf; m[i - 1] and c[i - 1] are the ones of the
+		/// leftmost line segment under children[i] in an inner node.
+		/// </summary>
+		alignas(16) float m[B];
+		alignas(16) float c[B];
+		/// <summary>
+		/// Parent node, NULL for the root.
+		/// </summary>
+		Inner* parent;
+	};
+
+	struct Inner : BNode {
+		BNode* children[B];
+	};
+
+	struct Leaf : BNode {
+		Segment segments[B];
+		/// <summary>
+		/// Neighbouring leaves.
+		/// </summary>
+		Leaf* prev;
+		Leaf* next;
+	};
+
+	/// <summary>
+	/// Points to the root node of the B+ Tree, NULL if the tree is empty.
+	/// </summary>
+	BNode* root_;
+	/// <summary>
+	/// Number of line segments, levels and nodes of the B+ Tree.
+	/// </summary>
+	size_t size_;
+	int levels_;
+	size_t inners_;
+	size_t leaves_;
+	/// <summary>
+	/// Leaf of the last search, NULL if it was deleted since.
+	/// </summary>
+	Leaf* finger_;
+	bool useFinger_;
+
+	TaggedAllocator<Inner, MemoryTag::Status> innerAllocator;
+	TaggedAllocator<Leaf, MemoryTag::Status> leafAllocator;
+
+	Inner* newInner() {
+		Inner* node = new (innerAllocator.allocate(1)) Inner();
+		node->leaf = false;
+		node->count = 0;
+		node->parent = nullptr;
+		inners_++;
+		return node;
+	}
+
+	Leaf* newLeaf() {
+		Leaf* node = new (leafAllocator.allocate(1)) Leaf();
+		node->leaf = true;
+		node->count = 0;
+		node->parent = nullptr;
+		node->prev = node->next = nullptr;
+		leaves_++;
+		return node;
+	}
+
+	void deleteNode(BNode* node) {
+		if (node == finger_)
+			finger_ = nullptr;
+		if (node->leaf) {
+			((Leaf*)node)->~Leaf();
+			leafAllocator.deallocate((Leaf*)node, 1);
+			leaves_--;
+		}
+		else {
+			((Inner*)node)->~Inner();
+			innerAllocator.deallocate((Inner*)node, 1);
+			inners_--;
+		}
+	}
+
+	/// <summary>
+	/// Function to count the keys of a node whose position on the horizontal line at y is less than x, or not
+	/// greater than x if upper is set, four keys at a time.
+	/// </summary>
+	/// <param name="node">The node.</param>
+	/// <param name="n">Number of keys to look at.</param>
+	static int rank(BNode* node, int n, float y, float x, bool upper) {
+		if (countersOn)
+			counters().statusComparisons += n;
+		int r = 0;
+		int i = 0;
+#ifdef __SSE2__
+		__m128 vy = _mm_set1_ps(y);
+		__m128 vx = _mm_set1_ps(x);
+		for (; i + 4 <= n; i += 4) {
+			__m128 kx = _mm_div_ps(_mm_sub_ps(vy, _mm_load_ps(node->c + i)), _mm_load_ps(node->m + i));
+			__m128 less = upper ? _mm_cmpnlt_ps(vx, kx) : _mm_cmplt_ps(kx, vx);
+			r += __builtin_popcount(_mm_movemask_ps(less));
+		}
+#endif
+		for (; i < n; i++) {
+			float kx = (y - node->c[i]) / node->m[i];
+			r += upper ? !(x < kx) : kx < x;
+		}
+		return r;
+	}
+
+	/// <summary>
+	/// Function to find the position of a key on the current sweep line.
+	/// </summary>
+	static float keyX(BNode* node, int i) {
+		return (Segment::k - node->c[i]) / node->m[i];
+	}
+
+	/// <summary>
+	/// Function to prefetch the part of a node the search reads.
+	/// </summary>
+	static void prefetch(BNode* node) {
+		for (const char* line = (const char*)node; line < (const char*)(node->c + B); line += 64)
+			__builtin_prefetch(line);
+	}
+
+	/// <summary>
+	/// Function to copy the key j of a node to the key i of another node.
+	/// </summary>
+	static void copyKey(BNode* to, int i, BNode* from, int j) {
+		to->m[i] = from->m[j];
+		to->c[i] = from->c[j];
+	}
+
+	/// <summary>
+	/// Function to copy the line segment j of a leaf to the position i of another leaf.
+	/// </summary>
+	static void copySegment(Leaf* to, int i, Leaf* from, int j) {
+		copyKey(to, i, from, j);
+		to->segments[i] = from->segments[j];
+	}
+
+	/// <summary>
+	/// Function to find the leftmost leaf under a node.
+	/// </summary>
+	static Leaf* firstLeaf(BNode* node) {
+		while (!node->leaf)
+			node = ((Inner*)node)->children[0];
+		return (Leaf*)node;
+	}
+
+	/// <summary>
+	/// Function to find the node a search can start from, climbing from the finger to the first inner node with
+	/// separators on both sides of the bound, or the root, and going down to the child between them. A bound d line segments
+	/// away from the finger climbs O(log d) levels. The leaf is always chosen by the separators of its parent, as
+	/// from the root: the keys of the finger alone may enclose the bound where the separators do not, once the
+	/// sweep has missed an intersection and left line segments out of order, and trusting them then loses more
+	/// intersections than the search from the root.
+	/// </summary>
+	BNode* start(float y, float x, bool upper) {
+		if (!useFinger_ || finger_ == nullptr)
+			return root_;
+
+		for (Inner* node = finger_->parent; node; node = node->parent) {
+			int i = rank(node, node->count - 1, y, x, upper);
+			if ((i > 0 && i < node->count - 1) || node->parent == nullptr)
+				return node->children[i];
+		}
+		return root_;
+	}
+
+	/// <summary>
+	/// Function to find the first line segment whose position on the horizontal line at y is not less than x,
+	/// or greater than x if upper is set. With the finger on, the search starts from the node start finds
+	/// instead of the root, and the leaf it ends at becomes the finger.
+	/// </summary>
+	/// <param name="pos">Variable which will be changed to the position in the leaf, the number of line
+	/// segments of the leaf if they are all before x.</param>
+	/// <returns>The leaf, NULL if the tree is empty.</returns>
+	Leaf* bound(float y, float x, bool upper, int& pos) {
+		if (root_ == nullptr)
+			return nullptr;
+
+		BNode* node = start(y, x, upper);
+		while (!node->leaf) {
+			BNode* child = ((Inner*)node)->children[rank(node, node->count - 1, y, x, upper)];
+			prefetch(child);
+			node = child;
+		}
+		pos = rank(node, node->count, y, x, upper);
+		finger_ = (Leaf*)node;
+		return (Leaf*)node;
+	}
+
+	/// <summary>
+	/// Function to find the index of a child in its parent.
+	/// </summary>
+	static int indexOf(Inner* parent, BNode* child) {
+		int i = 0;
+		while (parent->children[i] != child)
+			i++;
+		return i;
+	}
+
+	/// <summary>
+	/// Function to check if a line segment == val sorts just before a position, among the line segments at the
+	/// same place on the sweep line, which may go back over several leaves.
+	/// </summary>
+	bool duplicateBefore(Leaf* leaf, int pos, Segment& val, float x) {
+		while (leaf) {
+			for (int i = pos - 1; i >= 0; i--) {
+				if (keyX(leaf, i) < x)
+					return false;
+				if (leaf->segments[i] == val)
+					return true;
+			}
+			leaf = leaf->prev;
+			pos = leaf ? leaf->count : 0;
+		}
+		return false;
+	}
+
+	/// <summary>
+	/// Function to insert a line segment into a leaf.
+	/// </summary>
+	/// <param name="leaf">The leaf.</param>
+	/// <param name="pos">Position of the line segment in the leaf.</param>
+	/// <param name="val">The line segment.</param>
+	/// <returns>The new right sibling of the leaf if it was split, NULL if otherwise.</returns>
+	Leaf* insertInLeaf(Leaf* leaf, int pos, Segment& val) {
+		Leaf* right = nullptr;
+		if (leaf->count == B) {		// split the leaf in halves and link the new one after it
+			right = newLeaf();
+			int half = B / 2;
+			for (int i = half; i < B; i++)
+				copySegment(right, i - half, leaf, i);
+			right->count = B - half;
+			leaf->count = half;
+
+			right->next = leaf->next;
+			right->prev = leaf;
+			if (leaf->next)
+				leaf->next->prev = right;
+			leaf->next = right;
+
+			if (pos > half) {
+				leaf = right;
+				pos -= half;
+			}
+		}
+		for (int i = leaf->count; i > pos; i--)
+			copySegment(leaf, i, leaf, i - 1);
+		leaf->m[pos] = val.m;
+		leaf->c[pos] = val.c;
+		leaf->segments[pos] = val;
+		leaf->count++;
+		return right;
+	}
+
+	/// <summary>
+	/// Function to insert a line segment at a position of a leaf and carry the splits up.
+	/// </summary>
+	/// <returns>The leaf the line segment is in.</returns>
+	Leaf* insertAt(Leaf* leaf, int pos, Segment& val) {
+		BNode* node = leaf;
+		Leaf* right = insertInLeaf(leaf, pos, val);
+		Leaf* in = (right && pos > B / 2) ? right : leaf;
+		BNode* split = right;
+		while (split) {
+			Inner* parent = node->parent;
+			if (parent == nullptr) {		// grow a new root above the two halves
+				Inner* root = newInner();
+				root->children[0] = root_;
+				root->children[1] = split;
+				root_->parent = split->parent = root;
+				copyKey(root, 0, firstLeaf(split), 0);
+				root->count = 2;
+				root_ = root;
+				levels_++;
+				break;
+			}
+			split = insertChild(parent, indexOf(parent, node), split);
+			node = parent;
+		}
+		size_++;
+		return in;
+	}
+
+	/// <summary>
+	/// Function to add the new right sibling of a child which was split to an inner node.
+	/// </summary>
+	/// <param name="inner">The inner node.</param>
+	/// <param name="i">Index of the child which was split.</param>
+	/// <param name="split">The new right sibling of the child.</param>
+	/// <returns>The new right sibling of the inner node if it was split, NULL if otherwise.</returns>
+	Inner* insertChild(Inner* inner, int i, BNode* split) {
+		// The new child goes right after the one which was split
+		Leaf* sep = firstLeaf(split);
+		if (inner->count < B) {
+			for (int j = inner->count; j > i + 1; j--) {
+				inner->children[j] = inner->children[j - 1];
+				copyKey(inner, j - 1, inner, j - 2);
+			}
+			inner->children[i + 1] = split;
+			split->parent = inner;
+			copyKey(inner, i, sep, 0);
+			inner->count++;
+			return nullptr;
+		}
+
+		// Split a full node: of the B + 1 children, the left half keeps (B + 1) / 2 and the rest move to a new node
+		BNode* children[B + 1];
+		float m[B];
+		float c[B];
+		for (int j = 0, k = 0; j <= B; j++)
+			children[j] = (j == i + 1) ? split : inner->children[k++];
+		for (int j = 0, k = 0; j < B; j++) {
+			BNode* from = (j == i) ? (BNode*)sep : inner;
+			int at = (j == i) ? 0 : k++;
+			m[j] = from->m[at];
+			c[j] = from->c[at];
+		}
+
+		Inner* right = newInner();
+		int keep = (B + 1) / 2;
+		for (int j = 0; j < keep; j++) {
+			inner->children[j] = children[j];
+			children[j]->parent = inner;
+			if (j > 0) {
+				inner->m[j - 1] = m[j - 1];
+				inner->c[j - 1] = c[j - 1];
+			}
+		}
+		for (int j = keep; j <= B; j++) {
+			right->children[j - keep] = children[j];
+			children[j]->parent = right;
+			if (j > keep) {
+				right->m[j - keep - 1] = m[j - 1];
+				right->c[j - keep - 1] = c[j - 1];
+			}
+		}
+		inner->count = keep;
+		right->count = B + 1 - keep;
+		return right;
+	}
+
+	/// <summary>
+	/// Function to merge or refill the child of an inner node which has less than B / 2 entries left.
+	/// </summary>
+	/// <param name="node">The inner node.</param>
+	/// <param name="i">Index of the child.</param>
+	void rebalance(Inner* node, int i) {
+		BNode* c = node->children[i];
+		BNode* left = i > 0 ? node->children[i - 1] : nullptr;
+		BNode* right = i + 1 < node->count ? node->children[i + 1] : nullptr;
+
+		if (left && left->count > B / 2) {		// borrow the last entry of the left sibling
+			if (c->leaf) {
+				for (int j = c->count; j > 0; j--)
+					copySegment((Leaf*)c, j, (Leaf*)c, j - 1);
+				copySegment((Leaf*)c, 0, (Leaf*)left, left->count - 1);
+				copyKey(node, i - 1, c, 0);
+			}
+			else {
+				Inner* ci = (Inner*)c;
+				for (int j = c->count; j > 0; j--) {
+					ci->children[j] = ci->children[j - 1];
+					if (j > 1)
+						copyKey(c, j - 1, c, j - 2);
+				}
+				ci->children[0] = ((Inner*)left)->children[left->count - 1];
+				ci->children[0]->parent = ci;
+				copyKey(c, 0, node, i - 1);
+				copyKey(node, i - 1, left, left->count - 2);
+			}
+			left->count--;
+			c->count++;
+		}
+		else if (right && right->count > B / 2) {		// borrow the first entry of the right sibling
+			if (c->leaf) {
+				copySegment((Leaf*)c, c->count, (Leaf*)right, 0);
+				for (int j = 1; j < right->count; j++)
+					copySegment((Leaf*)right, j - 1, (Leaf*)right, j);
+				copyKey(node, i, right, 0);
+			}
+			else {
+				Inner* ci = (Inner*)c;
+				Inner* ri = (Inner*)right;
+				ci->children[c->count] = ri->children[0];
+				ci->children[c->count]->parent = ci;
+				copyKey(c, c->count - 1, node, i);
+				copyKey(node, i, right, 0);
+				for (int j = 1; j < right->count; j++) {
+					ri->children[j - 1] = ri->children[j];
+					if (j > 1)
+						copyKey(right, j - 2, right, j - 1);
+				}
+			}
+			right->count--;
+			c->count++;
+		}
+		else {		// merge with a sibling, the right one of the pair is deleted
+			if (left) {
+				right = c;
+				c = left;
+				i--;
+			}
+			if (c->leaf) {
+				Leaf* cl = (Leaf*)c;
+				Leaf* rl = (Leaf*)right;
+				for (int j = 0; j < right->count; j++)
+					copySegment(cl, c->count + j, rl, j);
+				cl->next = rl->next;
+				if (rl->next)
+					rl->next->prev = cl;
+			}
+			else {
+				Inner* ci = (Inner*)c;
+				Inner* ri = (Inner*)right;
+				copyKey(c, c->count - 1, node, i);
+				for (int j = 0; j < right->count; j++) {
+					ci->children[c->count + j] = ri->children[j];
+					ri->children[j]->parent = ci;
+					if (j > 0)
+						copyKey(c, c->count + j - 1, right, j - 1);
+				}
+			}
+			c->count += right->count;
+			deleteNode(right);
+
+			for (int j = i + 1; j + 1 < node->count; j++) {
+				node->children[j] = node->children[j + 1];
+				copyKey(node, j - 1, node, j);
+			}
+			node->count--;
+		}
+	}
+
+	/// <summary>
+	/// Function to remove the line segment == val under a node. The line segments at the same place on the sweep
+	/// line as val may be spread over several children, which are all looked at.
+	/// </summary>
+	/// <returns>True, if the line segment was removed; False if it is not in the tree.</returns>
+	bool removeNode(BNode* node, Segment& val, float x) {
+		if (node->leaf) {
+			Leaf* leaf = (Leaf*)node;
+			for (int pos = rank(leaf, leaf->count, Segment::k, x, false); pos < leaf->count && !(x < keyX(leaf, pos)); pos++) {
+				if (leaf->segments[pos] == val) {
+					for (int i = pos + 1; i < leaf->count; i++)
+						copySegment(leaf, i - 1, leaf, i);
+					leaf->count--;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		Inner* inner = (Inner*)node;
+		int first = rank(inner, inner->count - 1, Segment::k, x, false);
+		int last = rank(inner, inner->count - 1, Segment::k, x, true);
+		for (int i = first; i <= last; i++) {
+			if (!removeNode(inner->children[i], val, x))
+				continue;
+
+			if (i > 0 && inner->children[i]->count > 0)		// the leftmost line segment of the child may have been removed
+				copyKey(inner, i - 1, firstLeaf(inner->children[i]), 0);
+			if (inner->children[i]->count < B / 2 && inner->count > 1)
+				rebalance(inner, i);
+			return true;
+		}
+		return false;
+	}
+
+	/// <summary>
+	/// Function to find the line segment == val among the line segments at the same place on the sweep line as
+	/// val, which may be spread over several leaves.
+	/// </summary>
+	/// <param name="pos">Variable which will be changed to the position of the line segment in the leaf.</param>
+	/// <returns>The leaf, NULL if the line segment was not found.</returns>
+	Leaf* find(Segment& val, float x, int& pos) {
+		for (Leaf* leaf = bound(Segment::k, x, false, pos); leaf; leaf = leaf->next, pos = 0) {
+			for (; pos < leaf->count; pos++) {
+				if (x < keyX(leaf, pos))
+					return nullptr;
+				if (leaf->segments[pos] == val)
+					return leaf;
+			}
+		}
+		return nullptr;
+	}
+
+	/// <summary>
+	/// Function to remove the line segment at a position of a leaf, and carry the new leftmost line segment and
+	/// the rebalancing up only as far as they change the ancestors.
+	/// </summary>
+	void removeAt(Leaf* leaf, int pos) {
+		for (int i = pos + 1; i < leaf->count; i++)
+			copySegment(leaf, i - 1, leaf, i);
+		leaf->count--;
+
+		bool first = pos == 0;
+		BNode* node = leaf;
+		for (Inner* parent = node->parent; parent; node = parent, parent = node->parent) {
+			if (!first && node->count >= B / 2)
+				break;
+			int i = indexOf(parent, node);
+			if (first && i > 0 && node->count > 0)		// the leftmost line segment under the node was removed
+				copyKey(parent, i - 1, firstLeaf(node), 0);
+			if (node->count < B / 2 && parent->count > 1)
+				rebalance(parent, i);
+			first = first && i == 0;
+		}
+	}
+
+	/// <summary>
+	/// Function to remove the line segment at a position of a leaf from the Status.
+	/// </summary>
+	void erase(Leaf* leaf, int pos) {
+		removeAt(leaf, pos);
+		size_--;
+		shrink();
+	}
+
+	/// <summary>
+	/// Function to remove the line segment == val from the Status, searching every child it may be under from the
+	/// root, when the Status is out of order around it and find misses it.
+	/// </summary>
+	/// <returns>True, if the line segment was removed; False if it is not in the Status.</returns>
+	bool removeFromRoot(Segment& val, float x) {
+		if (!removeNode(root_, val, x))
+			return false;
+		size_--;
+		shrink();
+		return true;
+	}
+
+	/// <summary>
+	/// Function to drop the root after a removal when it has a single child, or no line segment, left.
+	/// </summary>
+	void shrink() {
+		if (!root_->leaf && root_->count == 1) {
+			BNode* old = root_;
+			root_ = ((Inner*)root_)->children[0];
+			root_->parent = nullptr;
+			deleteNode(old);
+			levels_--;
+		}
+		else if (root_->leaf && root_->count == 0) {
+			deleteNode(root_);
+			root_ = nullptr;
+			levels_ = 0;
+		}
+	}
+
+	/// <summary>
+	/// Function to delete all the nodes under a node.
+	/// </summary>
+	void clearTree(BNode* node) {
+		if (node == nullptr)
+			return;
+		if (!node->leaf)
+			for (int i = 0; i < node->count; i++)
+				clearTree(((Inner*)node)->children[i]);
+		deleteNode(node);
+	}
+
+public:
+
+	/// <summary>
+	/// Constructor to initialize the B+ Tree.
+	/// </summary>
+	BTreeStatus() {
+		root_ = nullptr;
+		size_ = 0;
+		levels_ = 0;
+		inners_ = leaves_ = 0;
+		finger_ = nullptr;
+		useFinger_ = true;
+	}
+
+	~BTreeStatus() {
+		clear();
+	}
+
+	BTreeStatus(const BTreeStatus&) = delete;
+	BTreeStatus& operator=(const BTreeStatus&) = delete;
+
+	/// <summary>
+	/// Function to insert a line segment into the Status.
+	/// </summary>
+	/// <param name="val">The line segment.</param>
+	/// <returns>True, if the line segment was inserted; False if a line segment == val was already in the Status.</returns>
+	bool insert(Segment val) {
+		if (root_ == nullptr) {
+			root_ = newLeaf();
+			levels_ = 1;
+		}
+
+		float x = (Segment::k - val.c) / val.m;
+		int pos;
+		Leaf* leaf = bound(Segment::k, x, true, pos);
+		if (duplicateBefore(leaf, pos, val, x))
+			return false;
+		insertAt(leaf, pos, val);
+		return true;
+	}
+
+	/// <summary>
+	/// Function to remove a line segment from the Status.
+	/// </summary>
+	/// <param name="val">The line segment.</param>
+	/// <returns>True, if the line segment was removed; False if it is not in the Status.</returns>
+	bool remove(Segment val) {
+		if (root_ == nullptr)
+			return false;
+
+		float x = (Segment::k - val.c) / val.m;
+		int pos;
+		Leaf* leaf = find(val, x, pos);
+		if (leaf == nullptr)
+			return removeFromRoot(val, x);
+		erase(leaf, pos);
+		return true;
+	}
+
+	/// <summary>
+	/// Function to insert a sorted range of line segments, the counterpart of AVLTree::unionWith. Only the first
+	/// line segment, and the ones which do not fit in the leaf of the one before, are searched for, so the range
+	/// mostly costs a rank of a leaf per line segment rather than a search.
+	/// </summary>
+	template <class It>
+	void unionWith(It first, It last) {
+		Leaf* leaf = nullptr;
+		for (; first != last; ++first) {
+			if (root_ == nullptr) {
+				root_ = newLeaf();
+				levels_ = 1;
+			}
+			// The line segments of the range go in one after the other, so each is put in the leaf of the one
+			// before while that leaf has line segments on both sides of it
+			float x = (Segment::k - first->c) / first->m;
+			int pos = -1;
+			if (leaf) {
+				int at = rank(leaf, leaf->count, Segment::k, x, true);
+				if (at > 0 && at < leaf->count)
+					pos = at;
+			}
+			if (pos < 0)
+				leaf = bound(Segment::k, x, true, pos);
+			if (!duplicateBefore(leaf, pos, *first, x))
+				leaf = insertAt(leaf, pos, *first);
+		}
+		if (leaf)
+			finger_ = leaf;
+	}
+
+	/// <summary>
+	/// Function to remove a sorted range of line segments, the counterpart of AVLTree::difference, leaf by leaf
+	/// like unionWith.
+	/// </summary>
+	template <class It>
+	void difference(It first, It last) {
+		Leaf* leaf = nullptr;
+		int pos = 0;
+		for (; first != last && root_; ++first) {
+			// The line segments of the range are next to each other in the Status, so each is usually found
+			// where the one before was removed
+			if (leaf == nullptr || pos >= leaf->count || !(leaf->segments[pos] == *first)) {
+				float x = (Segment::k - first->c) / first->m;
+				leaf = find(*first, x, pos);
+				if (leaf == nullptr) {
+					removeFromRoot(*first, x);
+					continue;
+				}
+			}
+			// The leaf is only kept if it is left alone by the rebalancing
+			bool kept = leaf->count > B / 2 || (leaf->parent == nullptr && leaf->count > 1);
+			erase(leaf, pos);
+			if (!kept)
+				leaf = nullptr;
+		}
+	}
+
+	/// <summary>
+	/// Function to find the left neighbour line segment of a point.
+	/// </summary>
+	/// <param name="p">The point.</param>
+	/// <returns>The last line segment passing to the left of the point, a default Segment if there is none.</returns>
+	Segment leftNeighbourOfPoint(Point& p) {
+		int pos;
+		Leaf* leaf = bound(p.y, p.x, false, pos);
+		return before(leaf, pos);
+	}
+
+	/// <summary>
+	/// Function to find the right neighbour line segment of a point.
+	/// </summary>
+	/// <param name="p">The point.</param>
+	/// <returns>The first line segment passing to the right of the point, a default Segment if there is none.</returns>
+	Segment rightNeighbourOfPoint(Point& p) {
+		int pos;
+		Leaf* leaf = bound(p.y, p.x, true, pos);
+		return at(leaf, pos);
+	}
+
+	/// <summary>
+	/// Function to find the left neighbour line segment of a line segment.
+	/// </summary>
+	/// <param name="s">The line segment.</param>
+	/// <returns>The last line segment to the left of it on the sweep line, a default Segment if there is none.</returns>
+	Segment leftNeighbourOfSegment(Segment& s) {
+		int pos;
+		Leaf* leaf = bound(Segment::k, (Segment::k - s.c) / s.m, false, pos);
+		return before(leaf, pos);
+	}
+
+	/// <summary>
+	/// Function to find the right neighbour line segment of a line segment.
+	/// </summary>
+	/// <param name="s">The line segment.</param>
+	/// <returns>The first line segment to the right of it on the sweep line, a default Segment if there is none.</returns>
+	Segment rightNeighbourOfSegment(Segment& s) {
+		int pos;
+		Leaf* leaf = bound(Segment::k, (Segment::k - s.c) / s.m, true, pos);
+		return at(leaf, pos);
+	}
+
+	/// <summary>
+	/// Function to turn the finger on or off, every search goes down from the root without it.
+	/// </summary>
+	void setFinger(bool on) {
+		useFinger_ = on;
+		finger_ = nullptr;
+	}
+
+	/// <summary>
+	/// Function to get the number of line segments in the Status.
+	/// </summary>
+	size_t size() {
+		return size_;
+	}
+
+	/// <summary>
+	/// Function to get the number of levels of the B+ Tree, 0 if it is empty.
+	/// </summary>
+	int treeHeight() {
+		return levels_;
+	}
+
+	/// <summary>
+	/// Function to get the number of bytes held by the nodes of the B+ Tree.
+	/// </summary>
+	size_t bytes() {
+		return inners_ * sizeof(Inner) + leaves_ * sizeof(Leaf);
+	}
+
+	/// <summary>
+	/// Function to delete all the line segments in the Status.
+	/// </summary>
+	void clear() {
+		clearTree(root_);
+		root_ = nullptr;
+		finger_ = nullptr;
+		size_ = 0;
+		levels_ = 0;
+	}
+
+private:
+	/// <summary>
+	/// Function to get the line segment at a position of a leaf, stepping to the next leaf past its end.
+	/// </summary>
+	static Segment at(Leaf* leaf, int pos) {
+		if (leaf && pos == leaf->count) {
+			leaf = leaf->next;
+			pos = 0;
+		}
+		return leaf ? leaf->segments[pos] : Segment();
+	}
+
+	/// <summary>
+	/// Function to get the line segment before a position of a leaf, stepping to the previous leaf before its start.
+	/// </summary>
+	static Segment before(Leaf* leaf, int pos) {
+		if (leaf && pos == 0) {
+			leaf = leaf->prev;
+			pos = leaf ? leaf->count : 0;
+		}
+		return leaf ? leaf->segments[pos - 1] : Segment();
+	}
+};
@@ -15,7 +15,7 @@ public:
 	/// Constructor to initialize the event queue.
 	/// </summary>
 	EventQueue() {
-		tree = new AVLTree<T>();
+		tree = new AVLTree<T, MemoryTag::EventQueue>();
 	}
 
 	/// <summary>
@@ -26,6 +26,30 @@ public:
 		tree->insert(val);
 	}
 
+	/// <summary>
+	/// Function to insert a data into the event queue, in place of the element equal to it if there is one.
+	/// </summary>
+	/// <param name="data">The data to be inserted into the event queue.</param>
+	void assign(T val) {
+		Node<T>* node = tree->search(val);
+		if (node)
+			node->data = val;
+		else
+			tree->insert(val);
+	}
+
+	/// <summary>
+	/// Function to replace the elements of the event queue with a sorted range, in O(n).
+	/// </summary>
+	/// <param name="first">Random access iterator to the first element of the range.</param>
+	/// <param name="last">Random access iterator past the last element of the range.</param>
+	/// <param name="threads">Number of threads the tree is built on, 0 for one per hardware thread.</param>
+	/// <remarks>The range must be sorted in the order of the queue and hold no equal elements.</remarks>
+	template <class It>
+	void build(It first, It last, unsigned threads = 1) {
+		tree->buildParallel(first, last, threads);
+	}
+
 	/// <summary>
 	/// Function to get the highest priority element in the event queue.
 	/// </summary>
@@ -42,7 +66,7 @@ public:
 	/// Function to pop the highest priority element in the event queue.
 	/// </summary>
 	void pop() {
-		tree->remove(this->top());
+		tree->removeMin();
 	}
 
 	/// <summary>
@@ -60,11 +84,27 @@ public:
 		return tree->getRoot() == nullptr;
 	}
 
+	/// <summary>
+	/// Function to get the number of elements in the event queue.
+	/// </summary>
+	/// <returns>The number of elements in the event queue.</returns>
+	size_t size() {
+		return tree->size();
+	}
+
+	/// <summary>
+	/// Function to get the height of the tree holding the event queue.
+	/// </summary>
+	/// <returns>The height of the AVL Tree.</returns>
+	int height() {
+		return tree->treeHeight();
+	}
+
 private:
 	/// <summary>
 	/// Pointer to the AVL Tree which is used to implement this data structure.
 	/// </summary>
-	AVLTree<T>* tree;
+	AVLTree<T, MemoryTag::EventQueue>* tree;
 };
 
 #endif
\ No newline at end of file
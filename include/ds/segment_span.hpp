@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "../geometry/segment.hpp"
+#include "../stats/memory_accounting.hpp"
+
+/// <summary>
+/// Small set of the line segments of an event point, sorted in the order of the Status. The segments are kept
+/// in a buffer on the stack and only go to the heap when there are more than Inline of them.
+/// </summary>
+/// <typeparam name="Inline">Number of line segments held without a heap allocation.</typeparam>
+template <size_t Inline = 16>
+class SegmentSpan {
+private:
+	Segment inline_[Inline];
+	std::vector<Segment, TaggedAllocator<Segment, MemoryTag::EventScratch>> heap_;
+	Segment* data_;
+	size_t size_;
+
+	/// <summary>
+	/// Function to sort the line segments with an insertion sort, which keeps the equal ones in the order they
+	/// were added, like the AVL Tree does, and stays in bounds with the comparisons of vertical and horizontal
+	/// line segments being inconsistent.
+	/// </summary>
+	void insertionSort() {
+		for (size_t i = 1; i < size_; i++) {
+			Segment s = data_[i];
+			size_t j = i;
+			for (; j > 0 && s < data_[j - 1]; j--)
+				data_[j] = data_[j - 1];
+			data_[j] = s;
+		}
+	}
+
+public:
+	SegmentSpan() {
+		data_ = inline_;
+		size_ = 0;
+	}
+
+	SegmentSpan(const SegmentSpan&) = delete;
+	SegmentSpan& operator=(const SegmentSpan&) = delete;
+
+	/// <summary>
+	/// Function to add a line segment at the end of the span.
+	/// </summary>
+	/// <param name="s">The line segment.</param>
+	void add(Segment& s) {
+		if (data_ == inline_ && size_ < Inline) {
+			inline_[size_++] = s;
+			return;
+		}
+		if (data_ == inline_)
+			heap_.assign(inline_, inline_ + size_);
+		heap_.resize(size_);		// sortUnique may have dropped some
+		heap_.push_back(s);
+		data_ = heap_.data();
+		size_++;
+	}
+
+	/// <summary>
+	/// Function to add line segments at the end of the span.
+	/// </summary>
+	/// <param name="segments">The line segments.</param>
+	template <class Vector>
+	void add(Vector& segments) {
+		for (Segment& s : segments)
+			add(s);
+	}
+
+	/// <summary>
+	/// Function to sort the line segments at the current sweep line and drop the duplicates in one pass over
+	/// the sorted span. The duplicates of a line segment are next to it, or separated from it only by line
+	/// segments at the same position, so only those are compared to it.
+	/// </summary>
+	void sortUnique() {
+		if (size_ <= Inline)
+			insertionSort();
+		else
+			std::stable_sort(data_, data_ + size_, [](Segment a, Segment b) { return a < b; });
+
+		size_t kept = 0;
+		for (size_t i = 0; i < size_; i++) {
+			bool duplicate = false;
+			for (size_t j = kept; j > 0 && !(data_[j - 1] < data_[i]); j--) {
+				if (data_[j - 1] == data_[i]) {
+					duplicate = true;
+					break;
+				}
+			}
+			if (!duplicate)
+				data_[kept++] = data_[i];
+		}
+		size_ = kept;
+	}
+
+	/// <summary>
+	/// Function to check if the span holds a line segment different from a given one.
+	/// </summary>
+	/// <param name="s">The line segment.</param>
+	bool containsOtherThan(Segment& s) {
+		for (size_t i = 0; i < size_; i++)
+			if (data_[i] != s)
+				return true;
+		return false;
+	}
+
+	Segment* begin() {
+		return data_;
+	}
+
+	Segment* end() {
+		return data_ + size_;
+	}
+
+	size_t size() {
+		return size_;
+	}
+
+	bool empty() {
+		return size_ == 0;
+	}
+
+	/// <summary>
+	/// The leftmost line segment, once sorted.
+	/// </summary>
+	Segment& front() {
+		return data_[0];
+	}
+
+	/// <summary>
+	/// The rightmost line segment, once sorted.
+	/// </summary>
+	Segment& back() {
+		return data_[size_ - 1];
+	}
+};
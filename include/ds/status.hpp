@@ -5,7 +5,7 @@
 /// <summary>
 /// Implementation of the Status data structure using a balanced binary search tree (AVL).
 /// </summary>
-class Status : public AVLTree<Segment> {
+class Status : public AVLTree<Segment, MemoryTag::Status> {
 private:
 
 	/// <summary>
@@ -52,46 +52,40 @@ private:
 	/// Function to find the leftChild neighbour segment of a line segment.
 	/// </summary>
 	/// <param name="root">The root node of the Status.</param>
-	/// <param name="given">The segment.</param>
+	/// <param name="x_g">Position of the line segment on the sweep line.</param>
 	/// <param name="ans">The line segment object whose data will be changed to the answer.</param>
-	void findLeftNeighbourSegment(Node<Segment>* root, Segment& given, Segment& ans) {
+	void findLeftNeighbourSegment(Node<Segment>* root, double x_g, Segment& ans) {
 
 		if (root == nullptr)
 			return;
-
-		findLeftNeighbourSegment(root->leftChild, given, ans);
-
-		Segment temp = root->data;
-		double x_t = (Segment::k - temp.c) / temp.m;
-		double x_g = (Segment::k - given.c) / given.m;
-
-		if (x_t < x_g)
-			ans = temp;
-
-		findLeftNeighbourSegment(root->rightChild, given, ans);
+		double x_t = (Segment::k - root->data.c) / root->data.m;
+		if (x_t < x_g) {
+			ans = root->data;
+			findLeftNeighbourSegment(root->rightChild, x_g, ans);
+		}
+		else {
+			findLeftNeighbourSegment(root->leftChild, x_g, ans);
+		}
 	}
 
 	/// <summary>
-	/// Function to find the leftChild neighbour segment of a line segment.
+	/// Function to find the rightChild neighbour segment of a line segment.
 	/// </summary>
 	/// <param name="root">The root node of the Status.</param>
-	/// <param name="given">The segment.</param>
+	/// <param name="x_g">Position of the line segment on the sweep line.</param>
 	/// <param name="ans">The line segment object whose data will be changed to the answer.</param>
-	void findRightNeighbourSegment(Node<Segment>* root, Segment& given, Segment& ans) {
+	void findRightNeighbourSegment(Node<Segment>* root, double x_g, Segment& ans) {
 
 		if (root == nullptr)
 			return;
-
-		findRightNeighbourSegment(root->rightChild, given, ans);
-
-		Segment temp = root->data;
-		double x_t = (Segment::k - temp.c) / temp.m;
-		double x_g = (Segment::k - given.c) / given.m;
-
-		if (x_t > x_g)
-			ans = temp;
-
-		findRightNeighbourSegment(root->leftChild, given, ans);
+		double x_t = (Segment::k - root->data.c) / root->data.m;
+		if (x_t > x_g) {
+			ans = root->data;
+			findRightNeighbourSegment(root->leftChild, x_g, ans);
+		}
+		else {
+			findRightNeighbourSegment(root->rightChild, x_g, ans);
+		}
 	}
 
 public:
@@ -125,7 +119,7 @@ public:
 	/// <returns>The leftChild neighbour line segment.</returns>
 	Segment leftNeighbourOfSegment(Segment& s) {
 		Segment ans;
-		findLeftNeighbourSegment(getRoot(), s, ans);
+		findLeftNeighbourSegment(getRoot(), (Segment::k - s.c) / s.m, ans);
 		return ans;
 	}
 
@@ -136,7 +130,7 @@ public:
 	/// <returns>The rightChild neighbour line segment.</returns>
 	Segment rightNeighbourOfSegment(Segment& s) {
 		Segment ans;
-		findRightNeighbourSegment(getRoot(), s, ans);
+		findRightNeighbourSegment(getRoot(), (Segment::k - s.c) / s.m, ans);
 		return ans;
 	}
 
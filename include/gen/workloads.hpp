@@ -0,0 +1,385 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Line segment as the two endpoints written to an input file.
+/// </summary>
+struct RawSegment {
+	double x1, y1, x2, y2;
+};
+
+/// <summary>
+/// Side of the square all the workloads are generated in.
+/// </summary>
+const double workloadSide = 1000;
+
+/// <summary>
+/// Function to get the names of the benchmark workloads.
+/// </summary>
+inline const std::vector<std::string>& workloadNames() {
+	static const std::vector<std::string> names = { "uniform", "short", "long", "near-parallel", "grid", "one-point", "roads" };
+	return names;
+}
+
+inline bool generateDistribution(const std::string& distribution, size_t n, uint64_t seed, std::vector<RawSegment>& segments);
+
+/// <summary>
+/// Function to generate a workload of line segments, the same seed always giving the same segments.
+///   uniform       - both endpoints uniform in the square, a constant fraction of the pairs intersect
+///   short         - uniform centres, lengths around the mean spacing, about n intersections
+///   long          - endpoints on the left and right sides, about n^2 / 4 intersections
+///   near-parallel - long segments whose slopes differ by less than 1e-3
+///   grid          - n / 2 slightly tilted rows crossing n / 2 slightly tilted columns, (n / 2)^2 intersections
+///   one-point     - every segment passes through the centre of the square
+///   roads         - the road networks of gen_segments, polylines whose consecutive events are close in the Status
+/// </summary>
+/// <param name="name">Name of the workload.</param>
+/// <param name="n">Number of line segments.</param>
+/// <param name="seed">Seed of the random generator.</param>
+/// <param name="segments">Vector which will be changed to the line segments.</param>
+/// <returns>True, if the workload exists; False if otherwise.</returns>
+inline bool generateWorkload(const std::string& name, size_t n, uint64_t seed, std::vector<RawSegment>& segments) {
+	std::mt19937_64 rng(seed);
+	std::uniform_real_distribution<double> coord(0, workloadSide);
+	std::uniform_real_distribution<double> unit(0, 1);
+	const double pi = std::acos(-1.0);
+
+	segments.clear();
+	segments.reserve(n);
+
+	if (name == "uniform") {
+		for (size_t i = 0; i < n; i++)
+			segments.push_back({ coord(rng), coord(rng), coord(rng), coord(rng) });
+	}
+	else if (name == "short") {
+		double length = 2 * workloadSide / std::sqrt((double)std::max<size_t>(n, 1));
+		for (size_t i = 0; i < n; i++) {
+			double x = coord(rng), y = coord(rng);
+			double a = unit(rng) * pi, l = length * (0.5 + unit(rng));
+			segments.push_back({ x, y, x + l * std::cos(a), y + l * std::sin(a) });
+		}
+	}
+	else if (name == "long") {
+		for (size_t i = 0; i < n; i++)
+			segments.push_back({ 0, coord(rng), workloadSide, coord(rng) });
+	}
+	else if (name == "near-parallel") {
+		for (size_t i = 0; i < n; i++) {
+			double y = coord(rng) * 0.5;
+			double slope = 0.5 + unit(rng) * 1e-3;
+			segments.push_back({ 0, y, workloadSide, y + slope * workloadSide });
+		}
+	}
+	else if (name == "grid") {
+		// Exactly horizontal or vertical segments have no usable slope / intercept, so the lattice is tilted slightly
+		size_t rows = n / 2, cols = n - rows;
+		for (size_t i = 0; i < rows; i++) {
+			double y = (i + 0.5) * workloadSide / rows;
+			segments.push_back({ 0, y, workloadSide, y + 1e-2 });
+		}
+		for (size_t i = 0; i < cols; i++) {
+			double x = (i + 0.5) * workloadSide / cols;
+			segments.push_back({ x, 0, x + 1e-2, workloadSide });
+		}
+	}
+	else if (name == "one-point") {
+		double c = workloadSide / 2;
+		for (size_t i = 0; i < n; i++) {
+			double a = (i + unit(rng)) * pi / n;		// distinct directions
+			double l1 = c * (0.2 + 0.8 * unit(rng)), l2 = c * (0.2 + 0.8 * unit(rng));
+			segments.push_back({ c - l1 * std::cos(a), c - l1 * std::sin(a), c + l2 * std::cos(a), c + l2 * std::sin(a) });
+		}
+	}
+	else if (name == "roads")
+		return generateDistribution("roads", n, seed, segments);
+	else
+		return false;
+	return true;
+}
+
+/// <summary>
+/// Function to write line segments to a file in the input.txt format.
+/// </summary>
+/// <param name="path">Path of the file.</param>
+/// <param name="segments">The line segments.</param>
+/// <returns>True, if the file was written; False if otherwise.</returns>
+inline bool writeSegments(const std::string& path, const std::vector<RawSegment>& segments) {
+	std::FILE* file = std::fopen(path.c_str(), "wb");
+	if (!file)
+		return false;
+
+	std::vector<char> buffer(1 << 20);
+	size_t used = 0;
+	auto put = [&](double v, char end) {
+		char* first = buffer.data() + used;
+		first = std::to_chars(first, buffer.data() + buffer.size(), (float)v).ptr;	// the sweep reads floats
+		*first++ = end;
+		used = first - buffer.data();
+	};
+
+	used = std::to_chars(buffer.data(), buffer.data() + buffer.size(), segments.size()).ptr - buffer.data();
+	buffer[used++] = '\n';
+	for (const RawSegment& s : segments) {
+		if (buffer.size() - used < 128) {
+			std::fwrite(buffer.data(), 1, used, file);
+			used = 0;
+		}
+		put(s.x1, ' ');
+		put(s.y1, ' ');
+		put(s.x2, ' ');
+		put(s.y2, '\n');
+	}
+	std::fwrite(buffer.data(), 1, used, file);
+	return std::fclose(file) == 0;
+}
+
+/// <summary>
+/// Function to read line segments from a file in the input.txt format.
+/// </summary>
+/// <param name="path">Path of the file.</param>
+/// <param name="segments">Vector which will be changed to the line segments.</param>
+/// <returns>True, if the file was read; False if otherwise.</returns>
+inline bool readSegments(const std::string& path, std::vector<RawSegment>& segments) {
+	std::FILE* file = std::fopen(path.c_str(), "r");
+	if (!file)
+		return false;
+
+	segments.clear();
+	unsigned long long n = 0;
+	bool ok = std::fscanf(file, "%llu", &n) == 1;
+	for (unsigned long long i = 0; ok && i < n; i++) {
+		RawSegment s;
+		ok = std::fscanf(file, "%lf %lf %lf %lf", &s.x1, &s.y1, &s.x2, &s.y2) == 4;
+		if (ok)
+			segments.push_back(s);
+	}
+	std::fclose(file);
+	return ok;
+}
+
+/// <summary>
+/// Options of the seeded line segment generator of gen_segments.
+/// </summary>
+struct GeneratorOptions {
+	std::string distribution = "uniform";
+	uint64_t n = 1000;
+	uint64_t seed = 1;
+	/// <summary>
+	/// Mean length of the poisson segments.
+	/// </summary>
+	double meanLength = 10;
+	/// <summary>
+	/// Number of intersecting pairs of the crossing distribution.
+	/// </summary>
+	uint64_t crossings = 0;
+	/// <summary>
+	/// Number of segments in every polyline of the roads distribution.
+	/// </summary>
+	size_t polylineLength = 16;
+};
+
+/// <summary>
+/// Number of line segments in a chunk of the generator. Every chunk has a random generator of its own,
+/// so the chunks can be generated in any order, on any number of threads, with the same result.
+/// </summary>
+const size_t generatorChunk = 1 << 16;
+
+/// <summary>
+/// Function to get the names of the distributions of the generator.
+/// </summary>
+inline const std::vector<std::string>& distributionNames() {
+	static const std::vector<std::string> names = { "uniform", "poisson", "manhattan", "roads", "crossing", "degenerate" };
+	return names;
+}
+
+/// <summary>
+/// Function to mix the bits of a seed, to derive independent seeds for the chunks.
+/// </summary>
+inline uint64_t mixSeed(uint64_t x) {
+	x += 0x9e3779b97f4a7c15ULL;
+	x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+	return x ^ (x >> 31);
+}
+
+/// <summary>
+/// Function to get the sizes of the two families of the crossing distribution: every one of the rows
+/// crosses every one of the columns, except the last column, which is cut short to make exactly k crossings.
+/// </summary>
+/// <param name="k">Number of intersecting pairs.</param>
+/// <param name="rows">Variable which will be changed to the number of rows.</param>
+/// <param name="cols">Variable which will be changed to the number of columns.</param>
+inline void crossingFamilies(uint64_t k, uint64_t& rows, uint64_t& cols) {
+	rows = (uint64_t)std::ceil(std::sqrt((double)k));
+	cols = rows ? (k + rows - 1) / rows : 0;
+}
+
+/// <summary>
+/// Function to generate a chunk of line segments, the segments [chunk * generatorChunk, (chunk + 1) * generatorChunk).
+///   uniform    - both endpoints uniform in the square
+///   poisson    - uniform centres and directions, Poisson distributed lengths (at least 1)
+///   manhattan  - axis parallel streets 1 to 8 blocks long on a square lattice, crossing and overlapping each other
+///   roads      - random walk polylines of polylineLength segments sharing their endpoints
+///   crossing   - two families of slightly tilted rows and columns with exactly k intersecting pairs in the left half
+///                of the square, the rest short disjoint segments in the right half
+///   degenerate - groups of 8 segments sharing an endpoint, lying on a common line, or vertical
+/// </summary>
+/// <param name="o">Options of the generator.</param>
+/// <param name="chunk">Index of the chunk.</param>
+/// <param name="segments">Vector which will be changed to the line segments of the chunk.</param>
+/// <returns>True, if the distribution exists; False if otherwise.</returns>
+inline bool generateChunk(const GeneratorOptions& o, uint64_t chunk, std::vector<RawSegment>& segments) {
+	std::mt19937_64 rng(mixSeed(o.seed ^ mixSeed(chunk)));
+	std::uniform_real_distribution<double> coord(0, workloadSide);
+	std::uniform_real_distribution<double> unit(0, 1);
+	const double pi = std::acos(-1.0);
+	const double n = (double)std::max<uint64_t>(o.n, 1);
+
+	uint64_t first = chunk * generatorChunk;
+	uint64_t last = std::min<uint64_t>(o.n, first + generatorChunk);
+	segments.clear();
+	if (first < last)
+		segments.reserve(last - first);
+
+	auto clamp = [](double v) { return std::min(std::max(v, 0.0), workloadSide); };
+
+	if (o.distribution == "uniform") {
+		for (uint64_t i = first; i < last; i++)
+			segments.push_back({ coord(rng), coord(rng), coord(rng), coord(rng) });
+	}
+	else if (o.distribution == "poisson") {
+		std::poisson_distribution<long long> length(o.meanLength);
+		for (uint64_t i = first; i < last; i++) {
+			double x = coord(rng), y = coord(rng);
+			double a = unit(rng) * pi, l = (double)std::max<long long>(length(rng), 1) / 2;
+			segments.push_back({ x - l * std::cos(a), y - l * std::sin(a), x + l * std::cos(a), y + l * std::sin(a) });
+		}
+	}
+	else if (o.distribution == "manhattan") {
+		uint64_t lines = (uint64_t)std::ceil(std::sqrt(n)) + 1;
+		double block = workloadSide / (lines - 1);
+		std::uniform_int_distribution<uint64_t> line(0, lines - 1);
+		std::uniform_int_distribution<uint64_t> blocks(1, 8);
+		for (uint64_t i = first; i < last; i++) {
+			double at = line(rng) * block;
+			uint64_t b = std::min(blocks(rng), lines - 1);
+			double from = std::uniform_int_distribution<uint64_t>(0, lines - 1 - b)(rng) * block;
+			double to = from + b * block;
+			if (i % 2)
+				segments.push_back({ at, from, at, to });		// avenue
+			else
+				segments.push_back({ from, at, to, at });		// street
+		}
+	}
+	else if (o.distribution == "roads") {
+		size_t length = std::max<size_t>(o.polylineLength, 1);
+		std::exponential_distribution<double> step(std::sqrt(n) / (2 * workloadSide));
+		std::normal_distribution<double> turn(0, 0.3);
+		double x = 0, y = 0, heading = 0;
+		for (uint64_t i = first; i < last; i++) {
+			if ((i - first) % length == 0) {
+				x = coord(rng), y = coord(rng);
+				heading = unit(rng) * 2 * pi;
+			}
+			heading += turn(rng);
+			double l = step(rng);
+			double nx = x + l * std::cos(heading), ny = y + l * std::sin(heading);
+			if (nx != clamp(nx) || ny != clamp(ny)) {	// turn around at the border of the square
+				heading += pi;
+				nx = clamp(nx), ny = clamp(ny);
+			}
+			segments.push_back({ x, y, nx, ny });
+			x = nx, y = ny;
+		}
+	}
+	else if (o.distribution == "crossing") {
+		uint64_t rows, cols;
+		crossingFamilies(o.crossings, rows, cols);
+		uint64_t rest = o.n > rows + cols ? o.n - rows - cols : 0;
+		uint64_t cells = (uint64_t)std::ceil(std::sqrt((double)std::max<uint64_t>(rest, 1)));
+		double half = workloadSide / 2;
+		double rowGap = rows ? workloadSide / rows : 0, colGap = cols ? half / cols : 0;
+		double cell = half / cells;
+		for (uint64_t i = first; i < last; i++) {
+			if (i < rows) {
+				// Exactly horizontal segments have no usable slope, so the rows are tilted by a fraction of their spacing
+				double y = (i + 0.5) * rowGap;
+				segments.push_back({ 0, y, half, y + 0.1 * rowGap });
+			}
+			else if (i < rows + cols) {
+				uint64_t c = i - rows;
+				double x = (c + 0.5) * colGap;
+				uint64_t crossed = (c + 1 == cols) ? o.crossings - rows * (cols - 1) : rows;
+				segments.push_back({ x, 0, x + 0.1 * colGap, crossed * rowGap });
+			}
+			else {
+				// A short diagonal strictly inside its own cell of a lattice, touching no other segment
+				uint64_t f = i - rows - cols;
+				double cx = half + (f % cells) * cell, cy = (f / cells) * cell;
+				double a = 0.1 + 0.3 * unit(rng), b = 0.6 + 0.3 * unit(rng);
+				segments.push_back({ cx + a * cell, cy + a * cell, cx + b * cell, cy + (b - 0.05) * cell });
+			}
+		}
+	}
+	else if (o.distribution == "degenerate") {
+		const uint64_t group = 8;
+		double reach = 4 * workloadSide / std::sqrt(n);
+		double x = 0, y = 0, a = 0;
+		for (uint64_t i = first; i < last; i++) {
+			uint64_t kind = (i / group) % 3;
+			if (i % group == 0 || i == first) {
+				x = coord(rng), y = coord(rng);
+				a = unit(rng) * pi;
+			}
+			if (kind == 0) {			// fan of segments sharing the endpoint (x, y)
+				double b = unit(rng) * 2 * pi, l = reach * (0.2 + unit(rng));
+				segments.push_back({ x, y, clamp(x + l * std::cos(b)), clamp(y + l * std::sin(b)) });
+			}
+			else if (kind == 1) {		// overlapping pieces of the line through (x, y) in direction a
+				double t1 = (unit(rng) - 0.5) * reach, t2 = t1 + reach * (0.2 + unit(rng));
+				segments.push_back({ x + t1 * std::cos(a), y + t1 * std::sin(a), x + t2 * std::cos(a), y + t2 * std::sin(a) });
+			}
+			else {						// vertical segments, half of them on the common line x
+				double vx = (i % 2) ? x : coord(rng);
+				double y1 = clamp(y + (unit(rng) - 0.5) * reach), y2 = clamp(y1 + reach * (0.2 + unit(rng)));
+				segments.push_back({ vx, y1, vx, y2 });
+			}
+		}
+	}
+	else
+		return false;
+	return true;
+}
+
+/// <summary>
+/// Function to generate all the line segments of a distribution of the generator, chunk by chunk.
+/// </summary>
+/// <param name="distribution">Name of the distribution.</param>
+/// <param name="n">Number of line segments.</param>
+/// <param name="seed">Seed of the random generator.</param>
+/// <param name="segments">Vector which will be changed to the line segments.</param>
+/// <returns>True, if the distribution exists; False if otherwise.</returns>
+inline bool generateDistribution(const std::string& distribution, size_t n, uint64_t seed, std::vector<RawSegment>& segments) {
+	GeneratorOptions o;
+	o.distribution = distribution;
+	o.n = n;
+	o.seed = seed;
+
+	std::vector<RawSegment> chunk;
+	segments.clear();
+	segments.reserve(n);
+	for (uint64_t c = 0; c * generatorChunk < n; c++) {
+		if (!generateChunk(o, c, chunk))
+			return false;
+		segments.insert(segments.end(), chunk.begin(), chunk.end());
+	}
+	return true;
+}
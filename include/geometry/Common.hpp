@@ -7,6 +7,7 @@
 
 #include "point.hpp"
 #include "segment.hpp"
+#include "../stats/memory_accounting.hpp"
 
 using namespace std;
 
@@ -21,7 +22,7 @@ struct Common {
     /// <summary>
     /// Vector to store all the line segments.
     /// </summary>
-    vector<Segment> segments;
+    vector<Segment, TaggedAllocator<Segment, MemoryTag::CommonVectors>> segments;
 
     Common() {}
 
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "segment.hpp"
+
+/// <summary>
+/// Function to find the x co-ordinate of a line segment at a given y co-ordinate.
+/// Interpolates between the endpoints so that vertical segments are handled as well.
+/// </summary>
+/// <param name="s">The line segment.</param>
+/// <param name="y">The y co-ordinate.</param>
+/// <returns>The x co-ordinate of the line segment at y.</returns>
+inline double xAtY(const Segment& s, double y) {
+	if (s.p_1.y == s.p_2.y)
+		return s.p_1.x;
+	return s.p_1.x + (y - s.p_1.y) * (double)(s.p_2.x - s.p_1.x) / (s.p_2.y - s.p_1.y);
+}
+
+/// <summary>
+/// Function to count the inversions of a sequence with merge sort, sorting it in the process.
+/// Only strict inversions (i < j and a[i] > a[j]) are counted.
+/// </summary>
+/// <param name="a">The sequence.</param>
+/// <param name="buffer">Scratch space of the same size as the sequence.</param>
+/// <param name="lo">First index of the range.</param>
+/// <param name="hi">One past the last index of the range.</param>
+/// <returns>The number of inversions in the range.</returns>
+inline long long countInversions(std::vector<double>& a, std::vector<double>& buffer, size_t lo, size_t hi) {
+	if (hi - lo < 2)
+		return 0;
+
+	size_t mid = lo + (hi - lo) / 2;
+	long long count = countInversions(a, buffer, lo, mid) + countInversions(a, buffer, mid, hi);
+
+	size_t i = lo, j = mid, k = lo;
+	while (i < mid && j < hi) {
+		if (a[i] <= a[j])
+			buffer[k++] = a[i++];
+		else {
+			count += mid - i;	// a[j] is smaller than every remaining element of the left half
+			buffer[k++] = a[j++];
+		}
+	}
+	while (i < mid)
+		buffer[k++] = a[i++];
+	while (j < hi)
+		buffer[k++] = a[j++];
+	std::copy(buffer.begin() + lo, buffer.begin() + hi, a.begin() + lo);
+	return count;
+}
+
+/// <summary>
+/// Function to count the pairs of line segments crossing between two horizontal lines without a sweep.
+/// Two segments spanning the whole band cross inside it exactly when their order along the upper line
+/// differs from their order along the lower line, so the count is the number of inversions, found in
+/// O(n log n). Segments which do not span the whole band are skipped.
+/// </summary>
+/// <param name="segments">The line segments.</param>
+/// <param name="yLow">Y co-ordinate of the lower line.</param>
+/// <param name="yHigh">Y co-ordinate of the upper line.</param>
+/// <param name="skipped">Variable which will be changed to the number of skipped segments.</param>
+/// <returns>The number of crossing pairs strictly between the two lines.</returns>
+inline long long countBandCrossings(const std::vector<Segment>& segments, double yLow, double yHigh, size_t& skipped) {
+	std::vector<std::pair<double, double>> ends;	// x along the upper line, x along the lower line
+	ends.reserve(segments.size());
+
+	for (const Segment& s : segments) {
+		double top = std::max(s.p_1.y, s.p_2.y);
+		double bottom = std::min(s.p_1.y, s.p_2.y);
+		if (top >= yHigh && bottom <= yLow && top > bottom)
+			ends.push_back({ xAtY(s, yHigh), xAtY(s, yLow) });
+	}
+	skipped = segments.size() - ends.size();
+
+	std::sort(ends.begin(), ends.end());
+
+	std::vector<double> lower(ends.size());
+	for (size_t i = 0; i < ends.size(); i++)
+		lower[i] = ends[i].second;
+
+	std::vector<double> buffer(lower.size());
+	return countInversions(lower, buffer, 0, lower.size());
+}
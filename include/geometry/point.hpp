@@ -95,9 +95,9 @@ public:
 };
 
 bool Point:: operator <= (Point const& p2) {
-    if (abs(y - p2.y) < eps) {
+    if (std::abs(y - p2.y) < eps) {
 
-        if (abs(x - p2.x) < eps)
+        if (std::abs(x - p2.x) < eps)
             return true;
         else
             return x < p2.x;
@@ -107,9 +107,9 @@ bool Point:: operator <= (Point const& p2) {
 }
 
 bool Point:: operator >= (Point const& p2) {
-    if (abs(y - p2.y) < eps) {
+    if (std::abs(y - p2.y) < eps) {
 
-        if (abs(x - p2.x) < eps)
+        if (std::abs(x - p2.x) < eps)
             return true;
         else
             return x > p2.x;
@@ -119,7 +119,7 @@ bool Point:: operator >= (Point const& p2) {
 }
 
 bool Point:: operator < (Point const& p2) {
-    if (abs(y - p2.y) < eps) {
+    if (std::abs(y - p2.y) < eps) {
         return x < p2.x;
     }
     else
@@ -127,7 +127,7 @@ bool Point:: operator < (Point const& p2) {
 }
 
 bool Point::operator > (Point const& p2) {
-    if (abs(y - p2.y) < eps) {
+    if (std::abs(y - p2.y) < eps) {
         return x > p2.x;
     }
     else
@@ -135,11 +135,11 @@ bool Point::operator > (Point const& p2) {
 }
 
 bool Point::operator == (Point const& p2) {
-    return (abs(x - p2.x) < eps && abs(y - p2.y) < eps);
+    return (std::abs(x - p2.x) < eps && std::abs(y - p2.y) < eps);
 }
 
 bool Point:: operator != (Point const& p2) {
-    return !(abs(x - p2.x) < eps && abs(y - p2.y) < eps);
+    return !(std::abs(x - p2.x) < eps && std::abs(y - p2.y) < eps);
 }
 
 
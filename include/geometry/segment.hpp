@@ -4,8 +4,10 @@
 #include <vector>
 #include <float.h>
 #include <cmath>
+#include <cstdint>
 
 #include "point.hpp"
+#include "../stats/counters.hpp"
 
 /// <summary>
 /// Defines the structure of a line segment.
@@ -29,6 +31,10 @@ public:
     /// </summary>
     float c;
     /// <summary>
+    /// Index of the line segment in the input, -1 if it was not read from the input.
+    /// </summary>
+    int64_t id;
+    /// <summary>
     /// Location of the sweep line to sort the line segments in the Status data structure.
     /// </summary>
     static inline float k = FLT_MAX;
@@ -41,6 +47,7 @@ public:
         p_1.x = p_1.y = FLT_MAX;
         p_2.x = p_2.y = FLT_MAX;
         m = c = FLT_MAX;
+        id = -1;
     }
 
     /// <summary>
@@ -48,9 +55,11 @@ public:
     /// </summary>
     /// <param name="p_1">1st end of the line segment.</param>
     /// <param name="p_2">2nd end of the line segment.</param>
-    Segment(Point p1, Point p2) {
+    /// <param name="id">Index of the line segment in the input.</param>
+    Segment(Point p1, Point p2, int64_t id = -1) {
         this->p_1 = p1;
         this->p_2 = p2;
+        this->id = id;
         m = (p2.y - p1.y) / (p2.x - p1.x);
         c = p1.y - (m * p1.x);
     }
@@ -110,12 +119,16 @@ public:
 
 
 bool Segment:: operator <= (Segment& s2) {
+    if (countersOn)
+        counters().statusComparisons++;
     float x = (k - c) / m;
     float x2 = (k - s2.c) / s2.m;
-    return (abs(x - x2) < eps || x < x2);
+    return (std::abs(x - x2) < eps || x < x2);
 }
 
 bool Segment:: operator < (Segment& s2) {
+    if (countersOn)
+        counters().statusComparisons++;
     float x = (k - c) / m;
     float x2 = (k - s2.c) / s2.m;
     return (x < x2);
@@ -123,13 +136,17 @@ bool Segment:: operator < (Segment& s2) {
 
 
 bool Segment:: operator >= (Segment& s2) {
+    if (countersOn)
+        counters().statusComparisons++;
     float x = (k - c) / m;
     float x2 = (k - s2.c) / s2.m;
-    return (abs(x - x2) < eps or x > x2);
+    return (std::abs(x - x2) < eps or x > x2);
 }
 
 
 bool Segment:: operator > (Segment& s2) {
+    if (countersOn)
+        counters().statusComparisons++;
     float x = (k - c) / m;
     float x2 = (k - s2.c) / s2.m;
     return (x > x2);
@@ -0,0 +1,623 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../geometry/point.hpp"
+#include "result_writer.hpp"
+#include "segment_ids.hpp"
+
+// Layout of a binary result file (all fixed width integers are little endian):
+//
+//   header  : "DAAR" | u32 version | u32 flags | u32 block size | f64 quantum
+//   blocks  : x column | y column | [ids column]       (one block per block size points)
+//   index   : per block u64 offset | u32 count | f32 max y | f32 min y
+//   footer  : u64 index offset | u64 block count | u64 point count | "DAAR"
+//
+// Points are stored in sweep order, so y is non-increasing within a file and its deltas are small.
+// Every column stores zigzag varint deltas of integer keys: either the order preserving bit pattern
+// of the float (lossless) or the value divided by the quantum (fixed point).
+// The ids column stores, per point, the number of segments through it followed by their sorted ids,
+// each delta coded against the previous id.
+
+/// <summary>
+/// Helper functions to encode and decode the columns of the binary result files.
+/// </summary>
+namespace binary_format {
+
+	const char magic[4] = { 'D', 'A', 'A', 'R' };
+	const uint32_t version = 2;
+	/// <summary>
+	/// Flag set in the header when the file stores the segment ids column.
+	/// </summary>
+	const uint32_t hasIdsFlag = 1;
+	const size_t headerSize = 24;
+	const size_t indexEntrySize = 24;
+	const size_t footerSize = 28;
+
+	/// <summary>
+	/// Function to map a float to an integer with the same ordering.
+	/// </summary>
+	inline int64_t floatKey(float v) {
+		uint32_t u;
+		std::memcpy(&u, &v, sizeof u);
+		u = (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+		return u;
+	}
+
+	/// <summary>
+	/// Function to map a key produced by floatKey back to the float.
+	/// </summary>
+	inline float keyFloat(int64_t key) {
+		uint32_t u = (uint32_t)key;
+		u = (u & 0x80000000u) ? (u & 0x7fffffffu) : ~u;
+		float v;
+		std::memcpy(&v, &u, sizeof v);
+		return v;
+	}
+
+	inline void putVarint(std::vector<uint8_t>& out, uint64_t v) {
+		while (v >= 0x80) {
+			out.push_back((uint8_t)(v | 0x80));
+			v >>= 7;
+		}
+		out.push_back((uint8_t)v);
+	}
+
+	/// <summary>
+	/// Function to decode a varint without reading past the end of the buffer.
+	/// </summary>
+	/// <param name="in">Position in the buffer, moved past the varint.</param>
+	/// <param name="end">End of the buffer.</param>
+	/// <param name="v">The decoded value.</param>
+	/// <returns>True, if a whole varint of at most 64 bits was read; False if otherwise.</returns>
+	inline bool getVarint(const uint8_t*& in, const uint8_t* end, uint64_t& v) {
+		v = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			if (in == end)
+				return false;
+			uint8_t byte = *in++;
+			v |= (uint64_t)(byte & 0x7f) << shift;
+			if (!(byte & 0x80))
+				return true;
+		}
+		return false;
+	}
+
+	inline void putSigned(std::vector<uint8_t>& out, int64_t v) {
+		putVarint(out, ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));		// zigzag
+	}
+
+	inline bool getSigned(const uint8_t*& in, const uint8_t* end, int64_t& v) {
+		uint64_t u;
+		if (!getVarint(in, end, u))
+			return false;
+		v = (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+		return true;
+	}
+
+	template <class I>
+	inline void putFixed(std::vector<uint8_t>& out, I v) {
+		for (size_t i = 0; i < sizeof(I); i++)
+			out.push_back((uint8_t)((uint64_t)v >> (8 * i)));
+	}
+
+	template <class I>
+	inline I getFixed(const uint8_t* in) {
+		uint64_t v = 0;
+		for (size_t i = 0; i < sizeof(I); i++)
+			v |= (uint64_t)in[i] << (8 * i);
+		return (I)v;
+	}
+
+	inline void putFloat(std::vector<uint8_t>& out, float f) {
+		uint32_t u;
+		std::memcpy(&u, &f, sizeof u);
+		putFixed<uint32_t>(out, u);
+	}
+
+	inline float getFloat(const uint8_t* in) {
+		uint32_t u = getFixed<uint32_t>(in);
+		float f;
+		std::memcpy(&f, &u, sizeof f);
+		return f;
+	}
+
+	inline void putDouble(std::vector<uint8_t>& out, double d) {
+		uint64_t u;
+		std::memcpy(&u, &d, sizeof u);
+		putFixed<uint64_t>(out, u);
+	}
+
+	inline double getDouble(const uint8_t* in) {
+		uint64_t u = getFixed<uint64_t>(in);
+		double d;
+		std::memcpy(&d, &u, sizeof d);
+		return d;
+	}
+}
+
+/// <summary>
+/// Writes the intersection points into the compressed, columnar binary result format.
+/// </summary>
+class BinaryResultWriter {
+public:
+
+	/// <summary>
+	/// Constructor to initialize a closed writer.
+	/// </summary>
+	/// <param name="blockSize">Number of points per block, the unit of random access.</param>
+	BinaryResultWriter(uint32_t blockSize = 4096) {
+		this->blockSize = blockSize;
+		file = nullptr;
+	}
+
+	~BinaryResultWriter() {
+		close();
+	}
+
+	/// <summary>
+	/// Function to open the output file and write the header.
+	/// </summary>
+	/// <param name="path">Path of the output file.</param>
+	/// <param name="withIds">True, to store the segment ids column.</param>
+	/// <param name="quantum">Fixed point resolution of the coordinates, 0 to store the floats losslessly.</param>
+	/// <returns>True, if the file could be opened; False if otherwise.</returns>
+	bool open(const std::string& path, bool withIds, double quantum = 0) {
+		file = std::fopen(path.c_str(), "wb");
+		if (!file)
+			return false;
+
+		this->withIds = withIds;
+		this->quantum = quantum;
+		failed = false;
+		offset = 0;
+		total = 0;
+		index.clear();
+
+		std::vector<uint8_t> header(binary_format::magic, binary_format::magic + 4);
+		binary_format::putFixed<uint32_t>(header, binary_format::version);
+		binary_format::putFixed<uint32_t>(header, withIds ? binary_format::hasIdsFlag : 0);
+		binary_format::putFixed<uint32_t>(header, blockSize);
+		binary_format::putDouble(header, quantum);
+		emit(header);
+		return true;
+	}
+
+	/// <summary>
+	/// Function to append an intersection point.
+	/// </summary>
+	/// <param name="p">The intersection point.</param>
+	/// <param name="ids">Sorted ids of the segments through the point, ignored if the ids column is off.</param>
+	/// <param name="count">Number of ids.</param>
+	void write(const Point& p, const int64_t* ids = nullptr, size_t count = 0) {
+		xs.push_back(p.x);
+		ys.push_back(p.y);
+		if (withIds)
+			pointIds.push(ids, count);
+		if (xs.size() == blockSize)
+			flushBlock();
+	}
+
+	/// <summary>
+	/// Function to write the pending block, the block index and the footer, then close the file.
+	/// </summary>
+	/// <returns>True, if every byte reached the file; False if a write failed, e.g. on a full disk.</returns>
+	bool close() {
+		if (!file)
+			return true;
+
+		flushBlock();
+
+		uint64_t indexOffset = offset;
+		std::vector<uint8_t> out;
+		for (auto& e : index) {
+			binary_format::putFixed<uint64_t>(out, e.offset);
+			binary_format::putFixed<uint32_t>(out, e.count);
+			binary_format::putFloat(out, e.maxY);
+			binary_format::putFloat(out, e.minY);
+			binary_format::putFixed<uint32_t>(out, 0);	// padding
+		}
+		binary_format::putFixed<uint64_t>(out, indexOffset);
+		binary_format::putFixed<uint64_t>(out, index.size());
+		binary_format::putFixed<uint64_t>(out, total);
+		out.insert(out.end(), binary_format::magic, binary_format::magic + 4);
+		emit(out);
+
+		bool ok = !failed && std::fclose(file) == 0;
+		file = nullptr;
+		return ok;
+	}
+
+private:
+
+	/// <summary>
+	/// Entry of the block index.
+	/// </summary>
+	struct BlockEntry {
+		uint64_t offset;
+		uint32_t count;
+		float maxY;
+		float minY;
+	};
+
+	/// <summary>
+	/// Function to convert a coordinate into the integer key stored in the columns.
+	/// </summary>
+	int64_t key(float v) {
+		if (quantum > 0)
+			return (int64_t)std::llround(v / quantum);
+		return binary_format::floatKey(v);
+	}
+
+	/// <summary>
+	/// Function to encode the buffered points as one block.
+	/// </summary>
+	void flushBlock() {
+		if (xs.empty())
+			return;
+
+		BlockEntry e;
+		e.offset = offset;
+		e.count = (uint32_t)xs.size();
+		e.maxY = e.minY = ys[0];
+
+		std::vector<uint8_t> out;
+		int64_t prev = 0;
+		for (float x : xs) {
+			int64_t k = key(x);
+			binary_format::putSigned(out, k - prev);
+			prev = k;
+		}
+		prev = 0;
+		for (float y : ys) {
+			int64_t k = key(y);
+			binary_format::putSigned(out, k - prev);
+			prev = k;
+			e.maxY = std::max(e.maxY, y);
+			e.minY = std::min(e.minY, y);
+		}
+		if (withIds) {
+			for (size_t i = 0; i < pointIds.size(); i++) {
+				const int64_t* ids = pointIds.begin(i);
+				binary_format::putVarint(out, pointIds.count(i));
+				prev = 0;
+				for (size_t j = 0; j < pointIds.count(i); j++) {
+					binary_format::putSigned(out, ids[j] - prev);
+					prev = ids[j];
+				}
+			}
+		}
+		emit(out);
+
+		index.push_back(e);
+		total += xs.size();
+		xs.clear();
+		ys.clear();
+		pointIds.clear();
+	}
+
+	void emit(const std::vector<uint8_t>& bytes) {
+		if (std::fwrite(bytes.data(), 1, bytes.size(), file) != bytes.size())
+			failed = true;
+		offset += bytes.size();
+	}
+
+	std::FILE* file;
+	/// <summary>
+	/// True once a write fell short, the offsets of the index being wrong from then on.
+	/// </summary>
+	bool failed = false;
+	uint32_t blockSize;
+	bool withIds = false;
+	double quantum = 0;
+	/// <summary>
+	/// Number of bytes written so far.
+	/// </summary>
+	uint64_t offset = 0;
+	/// <summary>
+	/// Number of points written so far.
+	/// </summary>
+	uint64_t total = 0;
+	std::vector<BlockEntry, TaggedAllocator<BlockEntry, MemoryTag::Results>> index;
+	std::vector<float, TaggedAllocator<float, MemoryTag::Results>> xs;
+	std::vector<float, TaggedAllocator<float, MemoryTag::Results>> ys;
+	SegmentIds pointIds;
+};
+
+/// <summary>
+/// Reads the binary result format, either whole blocks or the points within a range of y.
+/// </summary>
+class BinaryResultReader {
+public:
+
+	BinaryResultReader() {
+		file = nullptr;
+	}
+
+	~BinaryResultReader() {
+		close();
+	}
+
+	/// <summary>
+	/// Function to open a binary result file and load its block index.
+	/// The footer and the index are checked against the size of the file before anything is allocated from them.
+	/// </summary>
+	/// <param name="path">Path of the binary result file.</param>
+	/// <returns>True, if the file is a valid binary result file; False if otherwise, with the reason in errorMessage().</returns>
+	bool open(const std::string& path) {
+		close();
+		error.clear();
+		file = std::fopen(path.c_str(), "rb");
+		if (!file)
+			return fail("cannot open " + path);
+
+		uint8_t header[binary_format::headerSize];
+		uint8_t footer[binary_format::footerSize];
+		if (fseeko(file, 0, SEEK_END) != 0)
+			return fail("cannot seek in " + path);
+		uint64_t fileSize = (uint64_t)ftello(file);
+		if (fileSize < binary_format::headerSize + binary_format::footerSize)
+			return fail("file too short");
+		if (!readAt(0, header, sizeof header)
+			|| std::memcmp(header, binary_format::magic, 4) != 0
+			|| binary_format::getFixed<uint32_t>(header + 4) != binary_format::version)
+			return fail("not a version " + std::to_string(binary_format::version) + " binary result file");
+		if (!readAt(fileSize - sizeof footer, footer, sizeof footer)
+			|| std::memcmp(footer + 24, binary_format::magic, 4) != 0)
+			return fail("missing footer, the file may be truncated");
+
+		withIds = binary_format::getFixed<uint32_t>(header + 8) & binary_format::hasIdsFlag;
+		quantum = binary_format::getDouble(header + 16);
+		uint64_t indexOffset = binary_format::getFixed<uint64_t>(footer);
+		uint64_t blocks = binary_format::getFixed<uint64_t>(footer + 8);
+		total = binary_format::getFixed<uint64_t>(footer + 16);
+
+		// The index runs from its offset to the footer, so its size gives the number of blocks
+		uint64_t indexEnd = fileSize - sizeof footer;
+		if (indexOffset < binary_format::headerSize || indexOffset > indexEnd
+			|| (indexEnd - indexOffset) % binary_format::indexEntrySize != 0
+			|| (indexEnd - indexOffset) / binary_format::indexEntrySize != blocks)
+			return fail("block index does not fit the file");
+
+		std::vector<uint8_t> raw(blocks * binary_format::indexEntrySize);
+		if (!readAt(indexOffset, raw.data(), raw.size()))
+			return fail("cannot read the block index");
+
+		index.resize(blocks);
+		uint64_t points = 0;
+		for (uint64_t b = 0; b < blocks; b++) {
+			const uint8_t* e = raw.data() + b * binary_format::indexEntrySize;
+			index[b].offset = binary_format::getFixed<uint64_t>(e);
+			index[b].count = binary_format::getFixed<uint32_t>(e + 8);
+			index[b].maxY = binary_format::getFloat(e + 12);
+			index[b].minY = binary_format::getFloat(e + 16);
+			points += index[b].count;
+		}
+		for (uint64_t b = 0; b < blocks; b++) {
+			BlockEntry& e = index[b];
+			e.end = b + 1 < blocks ? index[b + 1].offset : indexOffset;
+			// Blocks follow each other from the header to the index, and every point takes at least a byte per column
+			if (e.offset != (b == 0 ? binary_format::headerSize : index[b - 1].end) || e.end < e.offset
+				|| e.count > (e.end - e.offset) / 2)
+				return fail("block " + std::to_string(b) + " does not fit the file");
+		}
+		if (points != total)
+			return fail("the blocks hold " + std::to_string(points) + " points, the footer " + std::to_string(total));
+		return true;
+	}
+
+	void close() {
+		if (file)
+			std::fclose(file);
+		file = nullptr;
+		index.clear();
+	}
+
+	/// <summary>
+	/// Function to get why the last open or read failed.
+	/// </summary>
+	std::string errorMessage() const {
+		return error;
+	}
+
+	/// <summary>
+	/// Function to get the number of points in the file.
+	/// </summary>
+	uint64_t size() {
+		return total;
+	}
+
+	/// <summary>
+	/// Function to get the number of blocks in the file.
+	/// </summary>
+	size_t blockCount() {
+		return index.size();
+	}
+
+	/// <summary>
+	/// Function to check if the file stores the segment ids column.
+	/// </summary>
+	bool hasIds() {
+		return withIds;
+	}
+
+	/// <summary>
+	/// Function to decode one block.
+	/// </summary>
+	/// <param name="b">Index of the block.</param>
+	/// <param name="points">Vector the points are appended to.</param>
+	/// <param name="ids">Table the segment ids are appended to, may be NULL.</param>
+	/// <returns>True, if the block was read whole; False if otherwise, nothing being appended and the reason in errorMessage().</returns>
+	bool readBlock(size_t b, std::vector<Point>& points, SegmentIds* ids = nullptr) {
+		if (b >= index.size())
+			return fail("no block " + std::to_string(b));
+		BlockEntry& e = index[b];
+		std::vector<uint8_t> raw(e.end - e.offset);
+		if (!readAt(e.offset, raw.data(), raw.size()))
+			return fail("cannot read block " + std::to_string(b));
+
+		const uint8_t* in = raw.data();
+		const uint8_t* end = raw.data() + raw.size();
+		size_t first = points.size();
+		size_t firstId = ids ? ids->ids.size() : 0;
+		size_t firstOffset = ids ? ids->offsets.size() : 0;
+		points.resize(first + e.count);
+
+		bool ok = true;
+		int64_t prev = 0, delta = 0;
+		for (uint32_t i = 0; ok && i < e.count; i++) {
+			ok = binary_format::getSigned(in, end, delta);
+			prev += delta;
+			points[first + i].x = value(prev);
+		}
+		prev = 0;
+		for (uint32_t i = 0; ok && i < e.count; i++) {
+			ok = binary_format::getSigned(in, end, delta);
+			prev += delta;
+			points[first + i].y = value(prev);
+		}
+		if (withIds && ids) {
+			for (uint32_t i = 0; ok && i < e.count; i++) {
+				uint64_t count;
+				ok = binary_format::getVarint(in, end, count) && count <= (uint64_t)(end - in);	// an id takes a byte at least
+				prev = 0;
+				for (uint64_t j = 0; ok && j < count; j++) {
+					ok = binary_format::getSigned(in, end, delta);
+					prev += delta;
+					ids->ids.push_back(prev);
+				}
+				ids->offsets.push_back(ids->ids.size());
+			}
+		}
+		if (!ok) {
+			points.resize(first);
+			if (ids) {
+				ids->ids.resize(firstId);
+				ids->offsets.resize(firstOffset);
+			}
+			return fail("block " + std::to_string(b) + " is corrupted");
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// Function to read every point whose y co-ordinate lies in [yLow, yHigh].
+	/// Only the blocks overlapping the range are read from disk.
+	/// </summary>
+	/// <param name="yLow">Lower end of the range.</param>
+	/// <param name="yHigh">Upper end of the range.</param>
+	/// <param name="points">Vector the points are appended to.</param>
+	/// <param name="ids">Table the segment ids are appended to, may be NULL.</param>
+	/// <returns>True, if every block in the range was read; False if otherwise, with the reason in errorMessage().</returns>
+	bool readRange(float yLow, float yHigh, std::vector<Point>& points, SegmentIds* ids = nullptr) {
+		std::vector<Point> blockPoints;
+		SegmentIds blockIds;
+		for (size_t b = 0; b < index.size(); b++) {
+			if (index[b].minY > yHigh || index[b].maxY < yLow)
+				continue;
+			blockPoints.clear();
+			blockIds.clear();
+			if (!readBlock(b, blockPoints, ids ? &blockIds : nullptr))
+				return false;
+			for (size_t i = 0; i < blockPoints.size(); i++) {
+				if (blockPoints[i].y < yLow || blockPoints[i].y > yHigh)
+					continue;
+				points.push_back(blockPoints[i]);
+				if (ids && withIds)
+					ids->push(blockIds.begin(i), blockIds.count(i));
+			}
+		}
+		return true;
+	}
+
+private:
+
+	/// <summary>
+	/// Entry of the block index, with the offset of the end of the block.
+	/// </summary>
+	struct BlockEntry {
+		uint64_t offset;
+		uint64_t end;
+		uint32_t count;
+		float maxY;
+		float minY;
+	};
+
+	/// <summary>
+	/// Function to read exactly the given number of bytes at an offset of the file.
+	/// </summary>
+	bool readAt(uint64_t offset, uint8_t* out, size_t size) {
+		return fseeko(file, (off_t)offset, SEEK_SET) == 0 && std::fread(out, 1, size, file) == size;
+	}
+
+	/// <summary>
+	/// Function to record why an operation failed.
+	/// </summary>
+	/// <returns>False.</returns>
+	bool fail(const std::string& message) {
+		error = message;
+		return false;
+	}
+
+	float value(int64_t key) {
+		if (quantum > 0)
+			return (float)(key * quantum);
+		return binary_format::keyFloat(key);
+	}
+
+	std::FILE* file;
+	bool withIds = false;
+	double quantum = 0;
+	uint64_t total = 0;
+	std::vector<BlockEntry> index;
+	std::string error;
+};
+
+/// <summary>
+/// Function to convert a binary result file back into the "x y [ids]" text format of output.txt.
+/// </summary>
+/// <param name="binaryPath">Path of the binary result file.</param>
+/// <param name="textPath">Path of the text file to be written.</param>
+/// <param name="error">Set to why the conversion failed.</param>
+/// <returns>True, if the conversion succeeded; False if otherwise.</returns>
+inline bool binaryToText(const std::string& binaryPath, const std::string& textPath, std::string& error) {
+	BinaryResultReader reader;
+	if (!reader.open(binaryPath)) {
+		error = reader.errorMessage();
+		return false;
+	}
+
+	ResultWriter writer;
+	if (!writer.open(textPath)) {
+		error = "cannot open " + textPath;
+		return false;
+	}
+
+	std::vector<Point> points;
+	SegmentIds ids;
+	for (size_t b = 0; b < reader.blockCount(); b++) {
+		points.clear();
+		ids.clear();
+		if (!reader.readBlock(b, points, &ids)) {
+			error = reader.errorMessage();
+			writer.close();
+			return false;
+		}
+		for (size_t i = 0; i < points.size(); i++) {
+			if (reader.hasIds())
+				writer.write(points[i], ids.begin(i), ids.count(i));
+			else
+				writer.write(points[i]);
+		}
+	}
+	if (!writer.close()) {
+		error = "cannot write " + textPath;
+		return false;
+	}
+	return true;
+}
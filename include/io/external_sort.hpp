@@ -0,0 +1,289 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+#include "../stats/memory_accounting.hpp"
+
+/// <summary>
+/// Function to create a temporary file which disappears once it is closed.
+/// </summary>
+/// <param name="dir">Directory of the file.</param>
+/// <param name="prefix">Prefix of the name of the file.</param>
+/// <returns>The file, open for reading and writing in binary mode; NULL if it could not be created.</returns>
+inline std::FILE* openTempFile(const std::string& dir, const std::string& prefix) {
+	std::string path = dir + "/" + prefix + "_XXXXXX";
+	int fd = mkstemp(&path[0]);
+	if (fd < 0)
+		return nullptr;
+	unlink(path.c_str());
+	std::FILE* file = fdopen(fd, "w+b");
+	if (!file)
+		close(fd);
+	return file;
+}
+
+/// <summary>
+/// External merge sort for trivially copyable records that may not fit in memory.
+/// Records are buffered up to the memory budget, sorted and spilled to disk as runs; reading them
+/// back merges the runs with a k-way merge running on a background thread, so that the sequential
+/// disk reads overlap with the consumer's work.
+/// </summary>
+/// <typeparam name="T">The record type, must be trivially copyable.</typeparam>
+/// <typeparam name="Compare">Strict weak ordering of the records.</typeparam>
+/// <typeparam name="Tag">The data structure the memory of the buffers is accounted to.</typeparam>
+template <class T, class Compare, MemoryTag Tag = MemoryTag::ExternalSort>
+class ExternalSorter {
+	static_assert(std::is_trivially_copyable<T>::value, "the records are written to and read from the runs as raw bytes");
+
+public:
+
+	/// <summary>
+	/// Constructor to initialize the sorter.
+	/// </summary>
+	/// <param name="memoryBudget">Number of bytes the buffered records may use.</param>
+	/// <param name="tempDir">Directory the runs are written to.</param>
+	ExternalSorter(size_t memoryBudget, const std::string& tempDir = ".") {
+		this->memoryBudget = std::max(memoryBudget, 64 * sizeof(T));
+		this->tempDir = tempDir;
+		runCapacity = this->memoryBudget / sizeof(T);
+	}
+
+	~ExternalSorter() {
+		stopMerge();
+		for (Run& r : runs)
+			std::fclose(r.file);
+	}
+
+	/// <summary>
+	/// Function to add a record, spilling a sorted run to disk when the buffer is full.
+	/// </summary>
+	/// <param name="v">The record.</param>
+	/// <returns>True, if the record was added; False if a run could not be written.</returns>
+	bool push(const T& v) {
+		buffer.push_back(v);
+		if (buffer.size() >= runCapacity)
+			return spill();
+		return true;
+	}
+
+	/// <summary>
+	/// Function to finish adding records and start reading them back in sorted order.
+	/// </summary>
+	/// <returns>True, if the records are ready to be read; False if a run could not be written.</returns>
+	bool finish() {
+		if (runs.empty()) {		// everything fit in memory, no merge needed
+			std::sort(buffer.begin(), buffer.end(), cmp);
+			current.swap(buffer);
+			pos = 0;
+			return true;
+		}
+
+		if (!buffer.empty() && !spill())
+			return false;
+		Buffer().swap(buffer);
+
+		// Half of the budget is shared by the read buffers of the runs, the rest by the merged blocks
+		size_t perRun = std::max<size_t>(memoryBudget / 2 / runs.size() / sizeof(T), 64);
+		blockSize = std::max<size_t>(memoryBudget / 4 / sizeof(T), 64);
+		for (Run& r : runs) {
+			std::rewind(r.file);
+			r.buffer.resize(perRun);
+			r.pos = r.len = 0;
+		}
+
+		merging = true;
+		merger = std::thread(&ExternalSorter::mergeLoop, this);
+		return true;
+	}
+
+	/// <summary>
+	/// Function to read the next record in sorted order.
+	/// </summary>
+	/// <param name="out">Variable which will be changed to the record.</param>
+	/// <returns>True, if a record was read; False if all the records have been read.</returns>
+	bool next(T& out) {
+		if (pos == current.size() && !fetch())
+			return false;
+		out = current[pos++];
+		return true;
+	}
+
+	/// <summary>
+	/// Function to look at the next record in sorted order without consuming it.
+	/// </summary>
+	/// <returns>Pointer to the next record, NULL if all the records have been read.</returns>
+	const T* peek() {
+		if (pos == current.size() && !fetch())
+			return nullptr;
+		return &current[pos];
+	}
+
+	/// <summary>
+	/// Function to get the number of runs spilled to disk.
+	/// </summary>
+	size_t runCount() {
+		return runs.size();
+	}
+
+	/// <summary>
+	/// Called with the records of every run once they are sorted, before they are written, and with the index of
+	/// the run. A run is read back in the order it was written, so data kept beside the records can be written
+	/// here in the same order and read back sequentially. Returns false to fail the spill.
+	/// </summary>
+	std::function<bool(T* records, size_t count, size_t run)> onSpill;
+
+private:
+
+	typedef std::vector<T, TaggedAllocator<T, Tag>> Buffer;
+
+	/// <summary>
+	/// A sorted run on disk and its read buffer.
+	/// </summary>
+	struct Run {
+		std::FILE* file;
+		Buffer buffer;
+		size_t pos;
+		size_t len;
+
+		bool refill() {
+			len = std::fread(buffer.data(), sizeof(T), buffer.size(), file);
+			pos = 0;
+			return len > 0;
+		}
+	};
+
+	/// <summary>
+	/// Function to sort the buffered records and write them to a new run file.
+	/// The file is unlinked right away, so it disappears once the sorter closes it.
+	/// </summary>
+	bool spill() {
+		std::sort(buffer.begin(), buffer.end(), cmp);
+		if (onSpill && !onSpill(buffer.data(), buffer.size(), runs.size()))
+			return false;
+
+		Run r;
+		r.file = openTempFile(tempDir, "daa_run");
+		r.pos = r.len = 0;
+		if (!r.file)
+			return false;
+		if (std::fwrite(buffer.data(), sizeof(T), buffer.size(), r.file) != buffer.size()) {
+			std::fclose(r.file);
+			return false;
+		}
+		runs.push_back(r);
+		buffer.clear();
+		return true;
+	}
+
+	/// <summary>
+	/// Body of the merge thread, merges the runs into blocks of records handed over to the consumer.
+	/// </summary>
+	void mergeLoop() {
+		// Min-heap on the head record of every run, as indices into runs
+		std::vector<size_t> heap;
+		auto after = [this](size_t a, size_t b) {
+			return cmp(runs[b].buffer[runs[b].pos], runs[a].buffer[runs[a].pos]);
+		};
+		for (size_t i = 0; i < runs.size(); i++)
+			if (runs[i].refill())
+				heap.push_back(i);
+		std::make_heap(heap.begin(), heap.end(), after);
+
+		Buffer block;
+		while (true) {
+			block.clear();
+			block.reserve(blockSize);
+			while (!heap.empty() && block.size() < blockSize) {
+				std::pop_heap(heap.begin(), heap.end(), after);
+				Run& r = runs[heap.back()];
+				block.push_back(r.buffer[r.pos++]);
+				if (r.pos < r.len || r.refill())
+					std::push_heap(heap.begin(), heap.end(), after);
+				else
+					heap.pop_back();
+			}
+
+			std::unique_lock<std::mutex> lock(mtx);
+			cv.wait(lock, [this] { return !hasReady || !merging; });
+			if (!merging)
+				return;
+			if (block.empty()) {
+				exhausted = true;
+				cv.notify_all();
+				return;
+			}
+			ready.swap(block);
+			hasReady = true;
+			cv.notify_all();
+		}
+	}
+
+	/// <summary>
+	/// Function to take the next merged block from the merge thread.
+	/// </summary>
+	bool fetch() {
+		if (!merger.joinable())
+			return false;
+
+		std::unique_lock<std::mutex> lock(mtx);
+		cv.wait(lock, [this] { return hasReady || exhausted; });
+		if (!hasReady)
+			return false;
+		current.swap(ready);
+		hasReady = false;
+		pos = 0;
+		cv.notify_all();
+		return true;
+	}
+
+	void stopMerge() {
+		if (!merger.joinable())
+			return;
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			merging = false;
+		}
+		cv.notify_all();
+		merger.join();
+	}
+
+	Compare cmp;
+	size_t memoryBudget;
+	std::string tempDir;
+	/// <summary>
+	/// Number of records buffered before a run is spilled.
+	/// </summary>
+	size_t runCapacity;
+	/// <summary>
+	/// Number of records per merged block.
+	/// </summary>
+	size_t blockSize = 0;
+	Buffer buffer;
+	std::vector<Run> runs;
+
+	/// <summary>
+	/// Block being read by the consumer.
+	/// </summary>
+	Buffer current;
+	size_t pos = 0;
+	/// <summary>
+	/// Block merged ahead by the merge thread.
+	/// </summary>
+	Buffer ready;
+	bool hasReady = false;
+	bool exhausted = false;
+	bool merging = false;
+	std::thread merger;
+	std::mutex mtx;
+	std::condition_variable cv;
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <vector>
+
+#include "../geometry/point.hpp"
+#include "../stats/memory_accounting.hpp"
+
+/// <summary>
+/// Window of the intersection points reported in a thin band above the sweep line, which merges the points
+/// closer than a tolerance to each other before they are emitted. The same intersection computed from different
+/// pairs of line segments lands on event points a little apart, and other event points may fall between them,
+/// so comparing a point with the one reported right before it misses them. A point is emitted once the sweep
+/// line is more than twice the tolerance below it, so the window only holds the points of that band, whatever
+/// the number of intersections.
+/// </summary>
+class ReportWindow {
+public:
+
+	/// <summary>
+	/// Sorted ids of the segments through a point.
+	/// </summary>
+	typedef std::vector<int64_t, TaggedAllocator<int64_t, MemoryTag::Results>> Ids;
+
+	/// <summary>
+	/// Constructor to initialize the window.
+	/// </summary>
+	/// <param name="tolerance">Distance in x and in y under which two points are the same.</param>
+	ReportWindow(float tolerance) {
+		this->tolerance = tolerance;
+	}
+
+	/// <summary>
+	/// Function to add an intersection point, after emitting the points the sweep line is past.
+	/// </summary>
+	/// <param name="p">The intersection point.</param>
+	/// <param name="idsBegin">Start of the sorted ids of the segments through the point.</param>
+	/// <param name="idsEnd">End of the sorted ids of the segments through the point.</param>
+	/// <param name="emit">Function called with every point and its ids leaving the window, in sweep order.</param>
+	/// <returns>True, if the point was merged into a point reported before; False if it was added.</returns>
+	template <class It, class Emit>
+	bool add(const Point& p, It idsBegin, It idsEnd, Emit emit) {
+		while (!entries.empty() && entries.front().point.y - p.y > 2 * tolerance) {
+			emit(entries.front().point, entries.front().ids);
+			entries.pop_front();
+		}
+
+		for (Entry& e : entries) {
+			if (std::abs(e.point.x - p.x) < tolerance && std::abs(e.point.y - p.y) < tolerance) {
+				merged.clear();
+				std::set_union(e.ids.begin(), e.ids.end(), idsBegin, idsEnd, std::back_inserter(merged));
+				e.ids.swap(merged);
+				return true;
+			}
+		}
+		entries.push_back({ p, Ids(idsBegin, idsEnd) });
+		return false;
+	}
+
+	/// <summary>
+	/// Function to emit all the points left in the window, once the sweep is over.
+	/// </summary>
+	template <class Emit>
+	void flush(Emit emit) {
+		for (Entry& e : entries)
+			emit(e.point, e.ids);
+		entries.clear();
+	}
+
+private:
+	struct Entry {
+		Point point;
+		Ids ids;
+	};
+
+	/// <summary>
+	/// Points of the window, in the order they were reported.
+	/// </summary>
+	std::deque<Entry, TaggedAllocator<Entry, MemoryTag::Results>> entries;
+	/// <summary>
+	/// Scratch buffer of the union of the ids of two points.
+	/// </summary>
+	Ids merged;
+	float tolerance;
+};
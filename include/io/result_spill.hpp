@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "../geometry/point.hpp"
+#include "external_sort.hpp"
+
+/// <summary>
+/// Intersection point buffered by the ResultSpill, with the location of its segment ids.
+/// </summary>
+struct ResultRecord {
+	Point point;
+	/// <summary>
+	/// Position of the segment ids in the ids buffered in memory, until the run of the point is spilled.
+	/// </summary>
+	uint64_t idsOffset;
+	uint32_t idsCount;
+	/// <summary>
+	/// Index of the run the point was spilled in, whose ids file holds its segment ids.
+	/// </summary>
+	uint32_t run;
+};
+
+/// <summary>
+/// Orders the intersection points by increasing x, then decreasing y.
+/// </summary>
+struct XOrder {
+	bool operator()(const ResultRecord& a, const ResultRecord& b) const {
+		if (a.point.x != b.point.x)
+			return a.point.x < b.point.x;
+		return a.point.y > b.point.y;
+	}
+};
+
+/// <summary>
+/// Result buffer with a memory cap for output in an order other than the sweep order.
+/// Points are kept in memory up to the cap, then flushed to disk as sorted runs, and a k-way merge
+/// produces the final ordered output. The segment ids of the points are kept in memory beside them, and
+/// written with every run to an ids file of the run in the order of its points, so that the merge reads
+/// each ids file sequentially.
+/// </summary>
+/// <typeparam name="Compare">Order of the output.</typeparam>
+template <class Compare>
+class ResultSpill {
+public:
+
+	/// <summary>
+	/// Constructor to initialize the buffer.
+	/// </summary>
+	/// <param name="memoryCap">Number of bytes the buffered points may use.</param>
+	/// <param name="tempDir">Directory for the sorted runs and the ids files.</param>
+	ResultSpill(size_t memoryCap, const std::string& tempDir = ".") : sorter(memoryCap, tempDir) {
+		this->tempDir = tempDir;
+		sorter.onSpill = [this](ResultRecord* records, size_t count, size_t run) { return spillIds(records, count, run); };
+	}
+
+	~ResultSpill() {
+		for (std::FILE* f : idsFiles)
+			std::fclose(f);
+	}
+
+	ResultSpill(const ResultSpill&) = delete;
+	ResultSpill& operator=(const ResultSpill&) = delete;
+
+	/// <summary>
+	/// Function to add an intersection point.
+	/// </summary>
+	/// <param name="p">The intersection point.</param>
+	/// <param name="ids">Ids of the segments through the point, may be NULL.</param>
+	/// <param name="count">Number of ids.</param>
+	/// <returns>True, if the point was added; False if the temporary files could not be written.</returns>
+	bool add(const Point& p, const int64_t* ids = nullptr, size_t count = 0) {
+		ResultRecord r = { p, pendingIds.size(), (uint32_t)count, 0 };
+		pendingIds.insert(pendingIds.end(), ids, ids + count);
+		return sorter.push(r);
+	}
+
+	/// <summary>
+	/// Function to emit all the points in order, merging the runs flushed to disk.
+	/// </summary>
+	/// <param name="emit">Called with the point, a pointer to its ids and their number.</param>
+	/// <returns>True, if all the points were emitted; False if the temporary files could not be read.</returns>
+	template <class F>
+	bool drain(F emit) {
+		if (!sorter.finish())
+			return false;
+		for (std::FILE* f : idsFiles)
+			std::rewind(f);
+
+		ResultRecord r;
+		std::vector<int64_t> ids;
+		while (sorter.next(r)) {
+			ids.resize(r.idsCount);
+			if (idsFiles.empty())		// nothing was spilled, the ids are still in memory
+				std::copy(pendingIds.begin() + r.idsOffset, pendingIds.begin() + r.idsOffset + r.idsCount, ids.begin());
+			else if (r.idsCount && std::fread(ids.data(), sizeof(int64_t), r.idsCount, idsFiles[r.run]) != r.idsCount)
+				return false;
+			emit(r.point, ids.data(), ids.size());
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// Function to get the number of sorted runs flushed to disk.
+	/// </summary>
+	size_t runCount() {
+		return sorter.runCount();
+	}
+
+private:
+
+	/// <summary>
+	/// Function to write the ids of a sorted run to a new ids file, in the order of the points of the run.
+	/// </summary>
+	bool spillIds(ResultRecord* records, size_t count, size_t run) {
+		std::FILE* file = openTempFile(tempDir, "daa_ids");
+		if (!file)
+			return false;
+		idsFiles.push_back(file);
+		for (size_t i = 0; i < count; i++) {
+			records[i].run = (uint32_t)run;
+			if (records[i].idsCount && std::fwrite(pendingIds.data() + records[i].idsOffset, sizeof(int64_t), records[i].idsCount, file) != records[i].idsCount)
+				return false;
+		}
+		pendingIds.clear();
+		return true;
+	}
+
+	ExternalSorter<ResultRecord, Compare, MemoryTag::Results> sorter;
+	std::string tempDir;
+	/// <summary>
+	/// Segment ids of the points not spilled yet.
+	/// </summary>
+	std::vector<int64_t, TaggedAllocator<int64_t, MemoryTag::Results>> pendingIds;
+	/// <summary>
+	/// Ids file of every run.
+	/// </summary>
+	std::vector<std::FILE*> idsFiles;
+};
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <charconv>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../geometry/point.hpp"
+#include "../stats/memory_accounting.hpp"
+
+/// <summary>
+/// Buffered sink for the intersection points.
+/// Points are formatted with std::to_chars (shortest round-trip) into a large buffer, which is handed
+/// over to a background I/O thread once full, so that formatting and writing to disk overlap.
+/// </summary>
+class ResultWriter {
+public:
+
+	/// <summary>
+	/// Constructor to initialize a closed writer.
+	/// </summary>
+	/// <param name="bufferSize">Size in bytes of each of the two write buffers.</param>
+	ResultWriter(size_t bufferSize = 1 << 20) {
+		this->bufferSize = bufferSize;
+		file = nullptr;
+		used = 0;
+		pending = false;
+		done = false;
+	}
+
+	/// <summary>
+	/// Destructor, flushes and closes the output file if it is still open.
+	/// </summary>
+	~ResultWriter() {
+		close();
+	}
+
+	/// <summary>
+	/// Function to open the output file and start the I/O thread.
+	/// </summary>
+	/// <param name="path">Path of the output file.</param>
+	/// <returns>True, if the file could be opened; False if otherwise.</returns>
+	bool open(const std::string& path) {
+		file = std::fopen(path.c_str(), "wb");
+		if (!file)
+			return false;
+
+		front.resize(bufferSize);
+		back.resize(bufferSize);
+		used = 0;
+		pending = false;
+		done = false;
+		failed = false;
+		io = std::thread(&ResultWriter::ioLoop, this);
+		return true;
+	}
+
+	/// <summary>
+	/// Function to write a point as a "x y" line.
+	/// </summary>
+	/// <param name="p">The point to be written.</param>
+	void write(const Point& p) {
+		// Two shortest round-trip floats, a space and a newline always fit into 64 bytes
+		if (bufferSize - used < 64)
+			flush();
+
+		char* first = front.data() + used;
+		char* last = front.data() + bufferSize;
+		first = std::to_chars(first, last, p.x).ptr;
+		*first++ = ' ';
+		first = std::to_chars(first, last, p.y).ptr;
+		*first++ = '\n';
+		used = first - front.data();
+	}
+
+	/// <summary>
+	/// Function to write a point followed by the ids of the segments through it as a "x y id id ..." line.
+	/// </summary>
+	/// <param name="p">The point to be written.</param>
+	/// <param name="ids">Pointer to the ids of the segments.</param>
+	/// <param name="count">Number of ids.</param>
+	void write(const Point& p, const int64_t* ids, size_t count) {
+		write(p);
+		used--;		// reopen the line
+
+		for (size_t i = 0; i < count; i++) {
+			if (bufferSize - used < 24)
+				flush();
+			char* first = front.data() + used;
+			*first++ = ' ';
+			first = std::to_chars(first, front.data() + bufferSize, ids[i]).ptr;
+			used = first - front.data();
+		}
+		front[used++] = '\n';
+	}
+
+	/// <summary>
+	/// Function to flush the remaining data, stop the I/O thread and close the output file.
+	/// </summary>
+	/// <returns>True, if every byte reached the file; False if a write failed, e.g. on a full disk.</returns>
+	bool close() {
+		if (!file)
+			return true;
+
+		flush();
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			done = true;
+		}
+		cv.notify_all();
+		io.join();
+
+		bool ok = !failed && std::fclose(file) == 0;
+		file = nullptr;
+		return ok;
+	}
+
+private:
+
+	/// <summary>
+	/// Function to hand the filled front buffer over to the I/O thread.
+	/// </summary>
+	void flush() {
+		std::unique_lock<std::mutex> lock(mtx);
+		cv.wait(lock, [this] { return !pending; });	// wait until the previous buffer has been written
+		front.swap(back);
+		backUsed = used;
+		used = 0;
+		pending = true;
+		lock.unlock();
+		cv.notify_all();
+	}
+
+	/// <summary>
+	/// Body of the I/O thread, writes every handed over buffer to the output file.
+	/// </summary>
+	void ioLoop() {
+		std::unique_lock<std::mutex> lock(mtx);
+		while (true) {
+			cv.wait(lock, [this] { return pending || done; });
+			if (pending) {
+				lock.unlock();
+				bool written = std::fwrite(back.data(), 1, backUsed, file) == backUsed;	// the buffer is owned by this thread while pending
+				lock.lock();
+				if (!written)
+					failed = true;
+				pending = false;
+				cv.notify_all();
+			}
+			else if (done)
+				return;
+		}
+	}
+
+	/// <summary>
+	/// Output file handle.
+	/// </summary>
+	std::FILE* file;
+	/// <summary>
+	/// Size in bytes of each write buffer.
+	/// </summary>
+	size_t bufferSize;
+	/// <summary>
+	/// Buffer being filled by the sweep.
+	/// </summary>
+	std::vector<char, TaggedAllocator<char, MemoryTag::Results>> front;
+	/// <summary>
+	/// Buffer being written by the I/O thread.
+	/// </summary>
+	std::vector<char, TaggedAllocator<char, MemoryTag::Results>> back;
+	/// <summary>
+	/// Number of bytes used in the front buffer.
+	/// </summary>
+	size_t used;
+	/// <summary>
+	/// Number of bytes used in the back buffer.
+	/// </summary>
+	size_t backUsed = 0;
+	/// <summary>
+	/// True while the back buffer is waiting to be written.
+	/// </summary>
+	bool pending;
+	/// <summary>
+	/// True once the writer is closing.
+	/// </summary>
+	bool done;
+	/// <summary>
+	/// True once a write of the I/O thread fell short.
+	/// </summary>
+	bool failed = false;
+	std::thread io;
+	std::mutex mtx;
+	std::condition_variable cv;
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <vector>
+
+// Line segments are read either from the text format of input.txt ("n" followed by one
+// "x1 y1 x2 y2" line per segment) or from the binary format:
+//
+//   "DAAS" | u32 version | u64 n | n * (f32 x1 | f32 y1 | f32 x2 | f32 y2)
+//
+// with all the values in the byte order of the machine writing them.
+
+/// <summary>
+/// Helper functions to read and write the line segment input files.
+/// </summary>
+namespace segment_file {
+
+	const char magic[4] = { 'D', 'A', 'A', 'S' };
+	const uint32_t version = 1;
+	const size_t headerSize = 16;
+	const size_t recordSize = 4 * sizeof(float);
+
+	/// <summary>
+	/// Function to append the header of a binary segment file.
+	/// </summary>
+	/// <param name="out">The buffer.</param>
+	/// <param name="n">Number of line segments in the file.</param>
+	inline void appendBinaryHeader(std::vector<char>& out, uint64_t n) {
+		out.insert(out.end(), magic, magic + 4);
+		const char* v = reinterpret_cast<const char*>(&version);
+		out.insert(out.end(), v, v + sizeof version);
+		const char* c = reinterpret_cast<const char*>(&n);
+		out.insert(out.end(), c, c + sizeof n);
+	}
+
+	/// <summary>
+	/// Function to append a line segment in the binary format.
+	/// </summary>
+	inline void appendBinary(std::vector<char>& out, float x1, float y1, float x2, float y2) {
+		float v[4] = { x1, y1, x2, y2 };
+		const char* c = reinterpret_cast<const char*>(v);
+		out.insert(out.end(), c, c + sizeof v);
+	}
+
+	/// <summary>
+	/// Function to append a line segment as a "x1 y1 x2 y2" line.
+	/// </summary>
+	inline void appendText(std::vector<char>& out, float x1, float y1, float x2, float y2) {
+		char line[96];
+		char* first = line;
+		char* last = line + sizeof line;
+		first = std::to_chars(first, last, x1).ptr;
+		*first++ = ' ';
+		first = std::to_chars(first, last, y1).ptr;
+		*first++ = ' ';
+		first = std::to_chars(first, last, x2).ptr;
+		*first++ = ' ';
+		first = std::to_chars(first, last, y2).ptr;
+		*first++ = '\n';
+		out.insert(out.end(), line, first);
+	}
+
+	/// <summary>
+	/// Function to check if a stream holds a binary segment file, and read its header if it does.
+	/// The stream is left at the start of the text otherwise.
+	/// </summary>
+	/// <param name="in">The input stream.</param>
+	/// <param name="n">Variable which will be changed to the number of line segments.</param>
+	/// <returns>True, if the stream holds a binary segment file; False if otherwise.</returns>
+	inline bool readBinaryHeader(std::istream& in, uint64_t& n) {
+		if (in.peek() != magic[0])
+			return false;
+
+		char header[headerSize];
+		if (!in.read(header, sizeof header) || std::memcmp(header, magic, 4) != 0) {
+			in.clear();
+			in.seekg(0);
+			return false;
+		}
+		std::memcpy(&n, header + 8, sizeof n);
+		return true;
+	}
+
+	/// <summary>
+	/// Function to read the next line segment of a binary segment file.
+	/// </summary>
+	inline bool readBinary(std::istream& in, float& x1, float& y1, float& x2, float& y2) {
+		float v[4];
+		if (!in.read(reinterpret_cast<char*>(v), sizeof v))
+			return false;
+		x1 = v[0];
+		y1 = v[1];
+		x2 = v[2];
+		y2 = v[3];
+		return true;
+	}
+}
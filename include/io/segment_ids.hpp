@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/// <summary>
+/// Stores the ids of the line segments through a sequence of intersection points in compressed
+/// sparse row layout: the ids of the i-th point are ids[offsets[i]] ... ids[offsets[i + 1] - 1].
+/// A point where m segments meet costs m ids and one offset, independent of the number of pairs.
+/// </summary>
+struct SegmentIds {
+	/// <summary>
+	/// Start of the ids of every point, followed by the total number of ids.
+	/// </summary>
+	std::vector<uint64_t> offsets = { 0 };
+	/// <summary>
+	/// Ids of the segments of all the points, one run per point.
+	/// </summary>
+	std::vector<int64_t> ids;
+
+	/// <summary>
+	/// Function to append the ids of the next point.
+	/// </summary>
+	/// <param name="first">Pointer to the first id.</param>
+	/// <param name="count">Number of ids.</param>
+	void push(const int64_t* first, size_t count) {
+		ids.insert(ids.end(), first, first + count);
+		offsets.push_back(ids.size());
+	}
+
+	/// <summary>
+	/// Function to get the number of points stored.
+	/// </summary>
+	size_t size() const {
+		return offsets.size() - 1;
+	}
+
+	/// <summary>
+	/// Function to get the ids of the i-th point.
+	/// </summary>
+	const int64_t* begin(size_t i) const {
+		return ids.data() + offsets[i];
+	}
+
+	/// <summary>
+	/// Function to get the number of ids of the i-th point.
+	/// </summary>
+	size_t count(size_t i) const {
+		return offsets[i + 1] - offsets[i];
+	}
+
+	void clear() {
+		offsets.assign(1, 0);
+		ids.clear();
+	}
+};
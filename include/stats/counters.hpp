@@ -0,0 +1,147 @@
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+/// <summary>
+/// Counters of the operations on the hot paths of the sweep.
+/// </summary>
+struct Counters {
+	/// <summary>
+	/// Event points processed.
+	/// </summary>
+	long long events = 0;
+	/// <summary>
+	/// Pairs of line segments tested for a new event point in findNewEvent.
+	/// </summary>
+	long long intersectionTests = 0;
+	/// <summary>
+	/// Results of doIntersect in findNewEvent.
+	/// </summary>
+	long long intersectTrue = 0;
+	long long intersectFalse = 0;
+	/// <summary>
+	/// Comparisons of line segments by their position on the sweep line.
+	/// </summary>
+	long long statusComparisons = 0;
+	/// <summary>
+	/// Rotations of the AVL Trees.
+	/// </summary>
+	long long rotations = 0;
+	/// <summary>
+	/// Intersection points found again while already in the event queue.
+	/// </summary>
+	long long duplicateEvents = 0;
+	/// <summary>
+	/// Intersection points found again within eps of a point reported before, and merged into it.
+	/// </summary>
+	long long duplicateReports = 0;
+	long long maxStatusSize = 0;
+	long long maxEventQueueSize = 0;
+	long long maxStatusHeight = 0;
+	long long maxEventQueueHeight = 0;
+
+	/// <summary>
+	/// Function to add the counters of another thread.
+	/// </summary>
+	void merge(const Counters& o) {
+		events += o.events;
+		intersectionTests += o.intersectionTests;
+		intersectTrue += o.intersectTrue;
+		intersectFalse += o.intersectFalse;
+		statusComparisons += o.statusComparisons;
+		rotations += o.rotations;
+		duplicateEvents += o.duplicateEvents;
+		duplicateReports += o.duplicateReports;
+		maxStatusSize = std::max(maxStatusSize, o.maxStatusSize);
+		maxEventQueueSize = std::max(maxEventQueueSize, o.maxEventQueueSize);
+		maxStatusHeight = std::max(maxStatusHeight, o.maxStatusHeight);
+		maxEventQueueHeight = std::max(maxEventQueueHeight, o.maxEventQueueHeight);
+	}
+
+	/// <summary>
+	/// Function to write the counters as a JSON object.
+	/// </summary>
+	/// <param name="os">The stream to write to.</param>
+	void writeJson(std::ostream& os) const {
+		long long tests = intersectTrue + intersectFalse;
+		os << "{\n";
+		os << "  \"events\": " << events << ",\n";
+		os << "  \"intersection_tests\": " << intersectionTests << ",\n";
+		os << "  \"do_intersect_true\": " << intersectTrue << ",\n";
+		os << "  \"do_intersect_false\": " << intersectFalse << ",\n";
+		os << "  \"do_intersect_true_ratio\": " << (tests ? (double)intersectTrue / tests : 0.0) << ",\n";
+		os << "  \"status_comparisons\": " << statusComparisons << ",\n";
+		os << "  \"avl_rotations\": " << rotations << ",\n";
+		os << "  \"duplicate_events_suppressed\": " << duplicateEvents << ",\n";
+		os << "  \"duplicate_reports_suppressed\": " << duplicateReports << ",\n";
+		os << "  \"max_status_size\": " << maxStatusSize << ",\n";
+		os << "  \"max_event_queue_size\": " << maxEventQueueSize << ",\n";
+		os << "  \"max_status_height\": " << maxStatusHeight << ",\n";
+		os << "  \"max_event_queue_height\": " << maxEventQueueHeight << "\n";
+		os << "}\n";
+	}
+};
+
+/// <summary>
+/// Counters of one thread. Each thread counts into its own copy without any synchronisation; the copies
+/// register themselves so that they can be merged, and add themselves to the total when their thread ends.
+/// </summary>
+class ThreadCounters {
+public:
+	Counters counts;
+
+	ThreadCounters() {
+		std::lock_guard<std::mutex> lock(mutex());
+		live().push_back(this);
+	}
+
+	~ThreadCounters() {
+		std::lock_guard<std::mutex> lock(mutex());
+		retired().merge(counts);
+		live().erase(std::find(live().begin(), live().end(), this));
+	}
+
+	/// <summary>
+	/// Function to merge the counters of all the threads, running or finished.
+	/// </summary>
+	static Counters merged() {
+		std::lock_guard<std::mutex> lock(mutex());
+		Counters total = retired();
+		for (ThreadCounters* t : live())
+			total.merge(t->counts);
+		return total;
+	}
+
+private:
+	static std::mutex& mutex() {
+		static std::mutex m;
+		return m;
+	}
+
+	static std::vector<ThreadCounters*>& live() {
+		static std::vector<ThreadCounters*> threads;
+		return threads;
+	}
+
+	static Counters& retired() {
+		static Counters total;
+		return total;
+	}
+};
+
+/// <summary>
+/// Set by --counters. The hot paths only touch the counters of their thread when it is set, so that without it
+/// a comparison pays for the load of a global and a branch the predictor always gets right.
+/// </summary>
+inline bool countersOn = false;
+
+/// <summary>
+/// Function to get the counters of the calling thread.
+/// </summary>
+inline Counters& counters() {
+	thread_local ThreadCounters t;
+	return t.counts;
+}
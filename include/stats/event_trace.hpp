@@ -0,0 +1,163 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Span of the handling of one event point.
+/// </summary>
+struct EventSpan {
+	float x, y;
+	/// <summary>
+	/// Number of line segments having the point as their upper endpoint, lower endpoint, and containing it.
+	/// </summary>
+	uint32_t u, l, c;
+	/// <summary>
+	/// Number of line segments in the Status after the event.
+	/// </summary>
+	uint32_t status;
+	/// <summary>
+	/// Start relative to the start of the trace and duration, in nanoseconds.
+	/// </summary>
+	int64_t start;
+	int64_t duration;
+
+	bool operator>(const EventSpan& o) const {
+		return duration > o.duration;
+	}
+};
+
+/// <summary>
+/// Records the spans of the event points into a ring buffer which keeps the latest ones.
+/// Only the sweep thread records, and the trace is read once the sweep is done, so nothing is synchronized;
+/// a parallel sweep would need a trace per thread. Every span, including the ones overwritten in the ring,
+/// is counted in a histogram of the durations and considered for the list of the slowest events.
+/// </summary>
+class EventTrace {
+public:
+
+	/// <summary>
+	/// Number of histogram buckets, bucket b holds the durations in [2^(b-1), 2^b) microseconds.
+	/// </summary>
+	static const int buckets = 32;
+
+	/// <summary>
+	/// Constructor to initialize the trace.
+	/// </summary>
+	/// <param name="capacity">Number of spans kept in the ring buffer.</param>
+	/// <param name="top">Number of slowest events kept.</param>
+	EventTrace(size_t capacity, size_t top = 10) : ring(std::max<size_t>(capacity, 1)) {
+		this->top = top;
+		head = 0;
+		for (auto& b : histogram)
+			b = 0;
+		origin = std::chrono::steady_clock::now();
+	}
+
+	/// <summary>
+	/// Function to get the time since the start of the trace.
+	/// </summary>
+	/// <returns>The time in nanoseconds.</returns>
+	int64_t now() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+	}
+
+	/// <summary>
+	/// Function to record the span of an event.
+	/// </summary>
+	void record(const EventSpan& span) {
+		ring[head++ % ring.size()] = span;
+
+		int64_t us = span.duration / 1000;
+		int b = 0;
+		while (us > 0 && b < buckets - 1) {
+			us >>= 1;
+			b++;
+		}
+		histogram[b]++;
+
+		if (slowest.size() < top)
+			slowest.push(span);
+		else if (top && span.duration > slowest.top().duration) {
+			slowest.pop();
+			slowest.push(span);
+		}
+	}
+
+	/// <summary>
+	/// Function to write the spans in the ring buffer in the Chrome trace event format, for chrome://tracing or Perfetto.
+	/// </summary>
+	/// <param name="path">Path of the JSON file.</param>
+	/// <returns>True, if the file was written; False if otherwise.</returns>
+	bool writeChromeTrace(const std::string& path) {
+		std::ofstream out(path);
+		if (!out)
+			return false;
+
+		uint64_t end = head;
+		uint64_t begin = end > ring.size() ? end - ring.size() : 0;
+		char line[256];
+		out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+		for (uint64_t i = begin; i < end; i++) {
+			const EventSpan& s = ring[i % ring.size()];
+			std::snprintf(line, sizeof line, "{\"name\": \"handleEvent\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, \"ts\": %.3f, \"dur\": %.3f, "
+				"\"args\": {\"x\": %g, \"y\": %g, \"U\": %u, \"L\": %u, \"C\": %u, \"status\": %u}}%s\n",
+				s.start / 1e3, s.duration / 1e3, s.x, s.y, s.u, s.l, s.c, s.status, i + 1 < end ? "," : "");
+			out << line;
+		}
+		out << "]}\n";
+		return (bool)out;
+	}
+
+	/// <summary>
+	/// Function to print the histogram of the event durations and the slowest events.
+	/// </summary>
+	/// <param name="os">The stream to print to.</param>
+	void printSummary(std::ostream& os) {
+		uint64_t total = head;
+		char line[160];
+		os << "\n\nhandleEvent durations (" << total << " events)";
+		int last = buckets - 1;
+		while (last > 0 && histogram[last] == 0)
+			last--;
+		for (int b = 0; b <= last; b++) {
+			uint64_t n = histogram[b];
+			std::string range = b == 0 ? "< 1 us" : "< " + std::to_string(1ULL << b) + " us";
+			std::snprintf(line, sizeof line, "\n  %-12s %12llu %6.2f%%", range.c_str(), (unsigned long long)n, total ? 100.0 * n / total : 0.0);
+			os << line;
+		}
+
+		std::vector<EventSpan> spans;
+		for (auto heap = slowest; !heap.empty(); heap.pop())
+			spans.push_back(heap.top());
+		std::sort(spans.begin(), spans.end(), std::greater<EventSpan>());
+		os << "\nSlowest events:";
+		for (const EventSpan& s : spans) {
+			std::snprintf(line, sizeof line, "\n  (%g, %g)  %10.1f us  |U| %u  |L| %u  |C| %u  status %u",
+				s.x, s.y, s.duration / 1e3, s.u, s.l, s.c, s.status);
+			os << line;
+		}
+	}
+
+private:
+	std::vector<EventSpan> ring;
+	/// <summary>
+	/// Number of spans recorded so far, the next one going to ring[head % ring.size()].
+	/// </summary>
+	uint64_t head;
+	uint64_t histogram[buckets];
+	/// <summary>
+	/// Min-heap of the slowest events.
+	/// </summary>
+	std::priority_queue<EventSpan, std::vector<EventSpan>, std::greater<EventSpan>> slowest;
+	size_t top;
+	std::chrono::steady_clock::time_point origin;
+};
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+
+/// <summary>
+/// Data structures whose memory is accounted separately.
+/// </summary>
+enum class MemoryTag {
+	EventQueue,
+	Status,
+	/// <summary>
+	/// Nodes of L, U and C.
+	/// </summary>
+	EventSegments,
+	/// <summary>
+	/// Line segment vectors of the Common entries.
+	/// </summary>
+	CommonVectors,
+	/// <summary>
+	/// Buffers of the intersection points on their way to the output.
+	/// </summary>
+	Results,
+	/// <summary>
+	/// Buffers of the external sort of the endpoints.
+	/// </summary>
+	ExternalSort,
+	/// <summary>
+	/// Scratch buffers of the handling of one event point, such as the line segments leaving and entering the Status.
+	/// </summary>
+	EventScratch,
+	Other,
+	Count
+};
+
+/// <summary>
+/// Bytes live, bytes peak and number of allocations of every tagged data structure, updated by the TaggedAllocators.
+/// </summary>
+class MemoryAccounting {
+public:
+
+	/// <summary>
+	/// Usage of one tag.
+	/// </summary>
+	struct Usage {
+		std::atomic<long long> live{ 0 };
+		std::atomic<long long> peak{ 0 };
+		std::atomic<long long> allocations{ 0 };
+	};
+
+	/// <summary>
+	/// Function to get the usage of a tag.
+	/// </summary>
+	static Usage& usage(MemoryTag tag) {
+		static Usage tags[(int)MemoryTag::Count];
+		return tags[(int)tag];
+	}
+
+	/// <summary>
+	/// Function to get the usage of all the tags together.
+	/// </summary>
+	static Usage& total() {
+		static Usage all;
+		return all;
+	}
+
+	/// <summary>
+	/// Function to get the name of a tag.
+	/// </summary>
+	static const char* name(int tag) {
+		static const char* names[] = { "event_queue", "status", "l_u_c", "common_vectors", "results", "external_sort", "event_scratch", "other" };
+		return names[tag];
+	}
+
+	static void allocate(MemoryTag tag, size_t bytes) {
+		add(usage(tag), (long long)bytes);
+		add(total(), (long long)bytes);
+		usage(tag).allocations.fetch_add(1, std::memory_order_relaxed);
+		total().allocations.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	static void deallocate(MemoryTag tag, size_t bytes) {
+		usage(tag).live.fetch_sub((long long)bytes, std::memory_order_relaxed);
+		total().live.fetch_sub((long long)bytes, std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// Function to print the usage of every tag as a table.
+	/// </summary>
+	/// <param name="os">The stream to print to.</param>
+	static void print(std::ostream& os) {
+		char line[128];
+		os << "\n\nStructure              live bytes     peak bytes    allocations";
+		for (int i = 0; i <= (int)MemoryTag::Count; i++) {
+			Usage& u = i < (int)MemoryTag::Count ? usage((MemoryTag)i) : total();
+			std::snprintf(line, sizeof line, "\n%-18s %14lld %14lld %14lld", i < (int)MemoryTag::Count ? name(i) : "total",
+				u.live.load(), u.peak.load(), u.allocations.load());
+			os << line;
+		}
+	}
+
+	/// <summary>
+	/// Function to write the usage of every tag as members of a JSON object.
+	/// </summary>
+	/// <param name="os">The stream to write to.</param>
+	static void writeJson(std::ostream& os) {
+		for (int i = 0; i <= (int)MemoryTag::Count; i++) {
+			Usage& u = i < (int)MemoryTag::Count ? usage((MemoryTag)i) : total();
+			std::string prefix = std::string("  \"memory_") + (i < (int)MemoryTag::Count ? name(i) : "total");
+			os << prefix << "_live_bytes\": " << u.live.load() << ",\n";
+			os << prefix << "_peak_bytes\": " << u.peak.load() << ",\n";
+			os << prefix << "_allocations\": " << u.allocations.load() << ",\n";
+		}
+	}
+
+private:
+	static void add(Usage& u, long long bytes) {
+		long long live = u.live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+		long long peak = u.peak.load(std::memory_order_relaxed);
+		while (live > peak && !u.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+			;
+	}
+};
+
+/// <summary>
+/// Allocator accounting the memory it hands out to a tag.
+/// </summary>
+/// <typeparam name="T">The element type.</typeparam>
+/// <typeparam name="Tag">The data structure the memory is accounted to.</typeparam>
+template <class T, MemoryTag Tag>
+struct TaggedAllocator {
+	typedef T value_type;
+
+	template <class U>
+	struct rebind {
+		typedef TaggedAllocator<U, Tag> other;
+	};
+
+	TaggedAllocator() {}
+
+	template <class U>
+	TaggedAllocator(const TaggedAllocator<U, Tag>&) {}
+
+	T* allocate(size_t n) {
+		MemoryAccounting::allocate(Tag, n * sizeof(T));
+		return std::allocator<T>().allocate(n);
+	}
+
+	void deallocate(T* p, size_t n) {
+		MemoryAccounting::deallocate(Tag, n * sizeof(T));
+		std::allocator<T>().deallocate(p, n);
+	}
+
+	template <class U>
+	bool operator==(const TaggedAllocator<U, Tag>&) const {
+		return true;
+	}
+
+	template <class U>
+	bool operator!=(const TaggedAllocator<U, Tag>&) const {
+		return false;
+	}
+};
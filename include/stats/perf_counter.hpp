@@ -0,0 +1,253 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/// <summary>
+/// Hardware performance counter of the calling thread, read through perf_event_open.
+/// The counter is not available when the kernel or the machine does not allow it (e.g. in containers
+/// or with a high perf_event_paranoid), in which case it reads 0. When the kernel multiplexes more events
+/// than the machine has counters, the count is scaled by the share of the time the event was counted.
+/// </summary>
+class PerfCounter {
+public:
+
+	/// <summary>
+	/// Constructor to open a counter.
+	/// </summary>
+	/// <param name="type">Type of the event, e.g. PERF_TYPE_HARDWARE.</param>
+	/// <param name="config">The event, e.g. PERF_COUNT_HW_CACHE_MISSES.</param>
+	/// <param name="inherit">True, to also count the threads started after the counter is opened. The kernel only
+	/// adds the count of such a thread to the counter when the thread exits, so a read sees none of a running thread.</param>
+	PerfCounter(uint32_t type, uint64_t config, bool inherit = false) {
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof attr);
+		attr.size = sizeof attr;
+		attr.type = type;
+		attr.config = config;
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.inherit = inherit;
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+		error = fd < 0 ? errno : 0;
+	}
+
+	~PerfCounter() {
+		if (fd >= 0)
+			close(fd);
+	}
+
+	PerfCounter(const PerfCounter&) = delete;
+	PerfCounter& operator=(const PerfCounter&) = delete;
+
+	/// <summary>
+	/// Function to check if the counter could be opened.
+	/// </summary>
+	bool available() const {
+		return fd >= 0;
+	}
+
+	/// <summary>
+	/// Function to get the reason the counter could not be opened.
+	/// </summary>
+	std::string errorMessage() const {
+		return error ? std::strerror(error) : "";
+	}
+
+	/// <summary>
+	/// Function to reset the counter to 0 and start counting.
+	/// </summary>
+	void start() {
+		if (fd < 0)
+			return;
+		ioctl(fd, PERF_EVENT_IOC_RESET, 0);	// resets the count but not the times, which are taken as the base instead
+		Reading r;
+		if (readRaw(r)) {
+			enabledBase = r.enabled;
+			runningBase = r.running;
+		}
+		ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+	}
+
+	/// <summary>
+	/// Function to stop counting.
+	/// </summary>
+	/// <returns>The number of events counted since start().</returns>
+	uint64_t stop() {
+		if (fd < 0)
+			return 0;
+		ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+		return value();
+	}
+
+	/// <summary>
+	/// Function to read the counter without stopping it.
+	/// </summary>
+	/// <returns>The number of events counted since start(), scaled up if the event was multiplexed.</returns>
+	uint64_t value() {
+		Reading r;
+		if (fd < 0 || !readRaw(r))
+			return 0;
+		uint64_t enabled = r.enabled - enabledBase;
+		uint64_t running = r.running - runningBase;
+		if (running == 0)	// never scheduled on a hardware counter
+			return 0;
+		if (running >= enabled)
+			return r.count;
+		return (uint64_t)((long double)r.count * enabled / running);
+	}
+
+private:
+	/// <summary>
+	/// Layout of a read with PERF_FORMAT_TOTAL_TIME_ENABLED and PERF_FORMAT_TOTAL_TIME_RUNNING.
+	/// </summary>
+	struct Reading {
+		uint64_t count;
+		/// <summary>
+		/// Nanoseconds the event was enabled, and of those the ones it was actually counted.
+		/// </summary>
+		uint64_t enabled;
+		uint64_t running;
+	};
+
+	bool readRaw(Reading& r) {
+		return read(fd, &r, sizeof r) == sizeof r;
+	}
+
+	int fd;
+	int error;
+	uint64_t enabledBase = 0;
+	uint64_t runningBase = 0;
+};
+
+/// <summary>
+/// The hardware counters reported for the phases of a run: cycles, instructions, L1 data cache and
+/// last level cache read misses, and branch misses. Counters the machine does not offer are left out.
+/// </summary>
+class PerfCounterSet {
+public:
+
+	/// <summary>
+	/// Constructor to open the counters, counting the calling thread and the threads it starts later.
+	/// The count of a started thread only arrives when it exits, so it goes to the phase the thread is joined in,
+	/// not to the phases it ran in.
+	/// </summary>
+	PerfCounterSet() {
+		const uint64_t readMiss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+		add("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+		add("instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+		add("l1d_misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | readMiss);
+		add("llc_misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL | readMiss);
+		add("branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+	}
+
+	~PerfCounterSet() {
+		for (PerfCounter* c : counters)
+			delete c;
+	}
+
+	/// <summary>
+	/// Function to check if any of the counters could be opened.
+	/// </summary>
+	bool available() const {
+		for (PerfCounter* c : counters)
+			if (c->available())
+				return true;
+		return false;
+	}
+
+	/// <summary>
+	/// Function to get the reason the counters could not be opened.
+	/// </summary>
+	std::string errorMessage() const {
+		return counters.empty() ? "" : counters[0]->errorMessage();
+	}
+
+	void start() {
+		for (PerfCounter* c : counters)
+			c->start();
+	}
+
+	/// <summary>
+	/// Function to end a phase: the counts since the end of the previous phase are stored under its name.
+	/// </summary>
+	/// <param name="phase">Name of the phase.</param>
+	void endPhase(const std::string& phase) {
+		std::vector<uint64_t> now;
+		for (PerfCounter* c : counters)
+			now.push_back(c->value());
+		std::vector<uint64_t> delta(now.size());
+		for (size_t i = 0; i < now.size(); i++) {
+			uint64_t before = last.empty() ? 0 : last[i];
+			delta[i] = now[i] > before ? now[i] - before : 0;	// a multiplexed count is an estimate and may step back
+		}
+		phases.push_back(phase);
+		counts.push_back(delta);
+		last = now;
+	}
+
+	/// <summary>
+	/// Function to print the counts of the phases as a table.
+	/// </summary>
+	/// <param name="os">The stream to print to.</param>
+	void print(std::ostream& os) {
+		if (!available()) {
+			os << "\n\nHardware counters not available (perf_event_open: " << errorMessage() << ")";
+			return;
+		}
+		char cell[32];
+		os << "\n\nPhase     ";
+		for (size_t i = 0; i < names.size(); i++)
+			if (counters[i]->available()) {
+				std::snprintf(cell, sizeof cell, " %15s", names[i].c_str());
+				os << cell;
+			}
+		os << "     IPC";
+		for (size_t p = 0; p < phases.size(); p++) {
+			std::snprintf(cell, sizeof cell, "\n%-10s", phases[p].c_str());
+			os << cell;
+			for (size_t i = 0; i < names.size(); i++)
+				if (counters[i]->available()) {
+					std::snprintf(cell, sizeof cell, " %15llu", (unsigned long long)counts[p][i]);
+					os << cell;
+				}
+			std::snprintf(cell, sizeof cell, " %7.2f", counts[p][0] ? (double)counts[p][1] / counts[p][0] : 0.0);
+			os << cell;
+		}
+	}
+
+	/// <summary>
+	/// Function to write the counts of the phases as "perf_<phase>_<counter>" members of a JSON object.
+	/// </summary>
+	/// <param name="os">The stream to write to.</param>
+	void writeJson(std::ostream& os) {
+		for (size_t p = 0; p < phases.size(); p++)
+			for (size_t i = 0; i < names.size(); i++)
+				if (counters[i]->available())
+					os << "  \"perf_" << phases[p] << '_' << names[i] << "\": " << counts[p][i] << ",\n";
+	}
+
+private:
+	void add(const std::string& name, uint32_t type, uint64_t config) {
+		names.push_back(name);
+		counters.push_back(new PerfCounter(type, config, true));
+	}
+
+	std::vector<std::string> names;
+	std::vector<PerfCounter*> counters;
+	std::vector<std::string> phases;
+	std::vector<std::vector<uint64_t>> counts;
+	std::vector<uint64_t> last;
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+// The timers are compiled in debug builds, and in release builds (NDEBUG) only when DAA_PHASE_TIMERS is defined
+#if !defined(NDEBUG) || defined(DAA_PHASE_TIMERS)
+#define DAA_PHASE_TIMERS_ENABLED 1
+#else
+#define DAA_PHASE_TIMERS_ENABLED 0
+#endif
+
+/// <summary>
+/// Phases of a run. The phases of the sweep are nested in it, the others follow each other.
+/// </summary>
+enum class Phase {
+	Parse,
+	Build,
+	Sweep,
+	EventPop,
+	StatusUpdate,
+	Neighbours,
+	FindNewEvent,
+	Report,
+	Output,
+	Teardown,
+	Count
+};
+
+/// <summary>
+/// Time spent in every phase of the run, added up by the ScopedTimers.
+/// </summary>
+class PhaseTimes {
+public:
+
+	static inline long long nanoseconds[(int)Phase::Count] = {};
+	static inline long long calls[(int)Phase::Count] = {};
+
+	/// <summary>
+	/// Function to get the name of a phase.
+	/// </summary>
+	static const char* name(int phase) {
+		static const char* names[] = { "parse", "build", "sweep", "event_pop", "status_update", "neighbours",
+			"find_new_event", "report", "output", "teardown" };
+		return names[phase];
+	}
+
+	/// <summary>
+	/// Function to check if a phase is nested in the sweep.
+	/// </summary>
+	static bool nested(int phase) {
+		return phase > (int)Phase::Sweep && phase < (int)Phase::Output;
+	}
+
+	/// <summary>
+	/// Function to print the phases as a table, with their share of the whole run.
+	/// </summary>
+	/// <param name="os">The stream to print to.</param>
+	static void print(std::ostream& os) {
+		if (!DAA_PHASE_TIMERS_ENABLED)
+			return;
+
+		long long total = 0;
+		for (int i = 0; i < (int)Phase::Count; i++)
+			if (!nested(i))
+				total += nanoseconds[i];
+
+		char line[128];
+		os << "\n\nPhase                      calls         ms   share";
+		for (int i = 0; i < (int)Phase::Count; i++) {
+			std::snprintf(line, sizeof line, "\n%s%-*s %10lld %10.3f %6.1f%%", nested(i) ? "  " : "", nested(i) ? 22 : 24,
+				name(i), calls[i], nanoseconds[i] / 1e6, total ? 100.0 * nanoseconds[i] / total : 0.0);
+			os << line;
+		}
+	}
+
+	/// <summary>
+	/// Function to write the phases as the "phases_us" member of a JSON object.
+	/// </summary>
+	/// <param name="os">The stream to write to.</param>
+	static void writeJson(std::ostream& os) {
+		if (!DAA_PHASE_TIMERS_ENABLED)
+			return;
+
+		os << "  \"phases_us\": {";
+		for (int i = 0; i < (int)Phase::Count; i++)
+			os << (i ? ", " : " ") << '"' << name(i) << "\": " << nanoseconds[i] / 1000;
+		os << " },\n";
+	}
+};
+
+/// <summary>
+/// Adds the time from its construction to its destruction to a phase.
+/// </summary>
+class ScopedTimer {
+public:
+	ScopedTimer(Phase phase) {
+		this->phase = phase;
+		start = std::chrono::steady_clock::now();
+	}
+
+	~ScopedTimer() {
+		auto stop = std::chrono::steady_clock::now();
+		PhaseTimes::nanoseconds[(int)phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+		PhaseTimes::calls[(int)phase]++;
+	}
+
+private:
+	Phase phase;
+	std::chrono::steady_clock::time_point start;
+};
+
+#define PHASE_TIMER_CONCAT(a, b) a##b
+#define PHASE_TIMER_NAME(line) PHASE_TIMER_CONCAT(phaseTimer, line)
+
+#if DAA_PHASE_TIMERS_ENABLED
+/// <summary>
+/// Times the rest of the enclosing scope as a phase.
+/// </summary>
+#define PHASE_TIMER(phase) ScopedTimer PHASE_TIMER_NAME(__LINE__)(phase)
+#else
+#define PHASE_TIMER(phase)
+#endif
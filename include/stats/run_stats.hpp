@@ -0,0 +1,112 @@
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "memory_accounting.hpp"
+#include "perf_counter.hpp"
+#include "phase_timer.hpp"
+
+/// <summary>
+/// Collects the statistics of a run of the sweep: the memory held by the sweep data structures,
+/// sampled after every event, and the resident memory of the process.
+/// </summary>
+class RunStats {
+public:
+
+	/// <summary>
+	/// Number of line segments in the input.
+	/// </summary>
+	size_t segments = 0;
+	/// <summary>
+	/// Number of event points processed by the sweep.
+	/// </summary>
+	size_t events = 0;
+	/// <summary>
+	/// Number of distinct intersection points found.
+	/// </summary>
+	long long points = 0;
+	/// <summary>
+	/// Number of intersecting segment pairs found.
+	/// </summary>
+	long long pairs = 0;
+	/// <summary>
+	/// Duration of the sweep in microseconds.
+	/// </summary>
+	long long sweepMicroseconds = 0;
+	/// <summary>
+	/// Hardware counters of the phases, NULL if they were not requested. Owned, so that every return of the run
+	/// closes their file descriptors.
+	/// </summary>
+	std::unique_ptr<PerfCounterSet> perf;
+
+	/// <summary>
+	/// Function to record the memory held by the sweep data structures after an event.
+	/// </summary>
+	/// <param name="bytes">Bytes held by all the data structures.</param>
+	/// <param name="status">Number of line segments in the Status.</param>
+	/// <param name="pending">Number of pending event points.</param>
+	void sample(size_t bytes, size_t status, size_t pending) {
+		currentBytes = bytes;
+		peakBytes = std::max(peakBytes, bytes);
+		peakStatus = std::max(peakStatus, status);
+		peakPending = std::max(peakPending, pending);
+	}
+
+	/// <summary>
+	/// Function to read a memory field of /proc/self/status.
+	/// </summary>
+	/// <param name="field">Name of the field, e.g. "VmRSS" or "VmHWM".</param>
+	/// <returns>The value in bytes, 0 if it is not available.</returns>
+	static size_t processMemory(const std::string& field) {
+		std::ifstream in("/proc/self/status");
+		std::string line;
+		while (std::getline(in, line))
+			if (line.compare(0, field.size() + 1, field + ":") == 0)
+				return std::stoull(line.substr(field.size() + 1)) * 1024;	// reported in kB
+		return 0;
+	}
+
+	/// <summary>
+	/// Function to print the statistics.
+	/// </summary>
+	/// <param name="os">The stream to print to.</param>
+	void print(std::ostream& os) {
+		os << "\nMemory held by the sweep (peak / final) : " << peakBytes << " / " << currentBytes << " bytes";
+		os << "\nLargest Status / event queue : " << peakStatus << " / " << peakPending;
+		os << "\nProcess resident memory (peak / final) : " << processMemory("VmHWM") << " / " << processMemory("VmRSS") << " bytes";
+	}
+
+	/// <summary>
+	/// Function to write the statistics as a JSON object.
+	/// </summary>
+	/// <param name="os">The stream to write to.</param>
+	void writeJson(std::ostream& os) {
+		os << "{\n";
+		os << "  \"segments\": " << segments << ",\n";
+		os << "  \"events\": " << events << ",\n";
+		os << "  \"intersection_points\": " << points << ",\n";
+		os << "  \"intersecting_pairs\": " << pairs << ",\n";
+		os << "  \"sweep_us\": " << sweepMicroseconds << ",\n";
+		PhaseTimes::writeJson(os);
+		MemoryAccounting::writeJson(os);
+		if (perf)
+			perf->writeJson(os);
+		os << "  \"sweep_memory_peak_bytes\": " << peakBytes << ",\n";
+		os << "  \"sweep_memory_final_bytes\": " << currentBytes << ",\n";
+		os << "  \"status_peak\": " << peakStatus << ",\n";
+		os << "  \"event_queue_peak\": " << peakPending << ",\n";
+		os << "  \"rss_peak_bytes\": " << processMemory("VmHWM") << ",\n";
+		os << "  \"rss_final_bytes\": " << processMemory("VmRSS") << "\n";
+		os << "}\n";
+	}
+
+private:
+	size_t currentBytes = 0;
+	size_t peakBytes = 0;
+	size_t peakStatus = 0;
+	size_t peakPending = 0;
+};
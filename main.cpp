@@ -2,53 +2,165 @@
 #include <fstream>
 #include <vector>
 #include <chrono>
+#include <algorithm>
 
 #include "./include/geometry/point.hpp"
 #include "./include/geometry/segment.hpp"
 #include "./include/geometry/helpers.hpp"
 #include "./include/geometry/Common.hpp"
+#include "./include/geometry/band_count.hpp"
 
 #include "./include/AVLTree/tree.hpp"
 
 #include "./include/ds/event_queue.hpp"
 #include "./include/ds/status.hpp"
+#include "./include/ds/btree_status.hpp"
+#include "./include/ds/segment_span.hpp"
+
+#include "./include/io/result_writer.hpp"
+#include "./include/io/binary_results.hpp"
+#include "./include/io/external_sort.hpp"
+#include "./include/io/result_spill.hpp"
+#include "./include/io/segment_file.hpp"
+#include "./include/io/report_window.hpp"
+
+#include "./include/stats/run_stats.hpp"
+#include "./include/stats/phase_timer.hpp"
+#include "./include/stats/counters.hpp"
+#include "./include/stats/event_trace.hpp"
+#include "./include/stats/memory_accounting.hpp"
 
 using namespace std;
 
 /// <summary>
 /// File to store the output data into.
 /// </summary>
-ofstream outputFile("./output.txt");
+ResultWriter outputFile;
 
 /// <summary>
-/// File to store the input data into.
+/// Binary file to store the output data into, used instead of the text file when binaryOutput is set.
 /// </summary>
-ofstream inputFile("./input.txt");
+BinaryResultWriter binaryFile;
+bool binaryOutput = false;
+/// <summary>
+/// Set to report the ids of all the segments through every intersection point.
+/// </summary>
+bool segmentIds = false;
+
+/// <summary>
+/// Set to print every intersection point to the console as it is found.
+/// </summary>
+bool display = true;
+
+/// <summary>
+/// Result buffer used when the output is requested by increasing x instead of in sweep order, NULL otherwise.
+/// </summary>
+ResultSpill<XOrder>* xOrdered = nullptr;
+
+/// <summary>
+/// Set to only count the intersections, without writing any intersection point.
+/// </summary>
+bool countOnly = false;
+/// <summary>
+/// Number of distinct intersection points found.
+/// </summary>
+long long pointCount = 0;
+/// <summary>
+/// Number of intersecting segment pairs found, a point where m segments meet adds m(m-1)/2.
+/// </summary>
+long long pairCount = 0;
+/// <summary>
+/// The intersection points reported in the last few eps of the sweep, held to merge the ones found more than once.
+/// The Status is ordered 2 * eps below the event point, so points closer than that are not told apart by it.
+/// </summary>
+ReportWindow reported(2 * Point::eps);
+
+/// <summary>
+/// File to store the input data into, when it is entered on the console.
+/// </summary>
+ofstream inputFile;
 
 /// <summary>
 /// Creating the event queue data structure.
 /// </summary>
 EventQueue<Point> eq;
 /// <summary>
+/// AVL Tree of the Common entries of L, U and C, their nodes are accounted together.
+/// </summary>
+typedef AVLTree<Common, MemoryTag::EventSegments> CommonTree;
+/// <summary>
 /// Creating an AVL Tree to store all the line segments that have a particular point as it's lower point.
 /// </summary>
-AVLTree<Common> L;
+CommonTree L;
 /// <summary>
 /// Creating an AVL Tree to store all the line segments that have a particular point as it's upper point.
 /// </summary>
-AVLTree<Common> U;
+CommonTree U;
 /// <summary>
 /// Creating an AVL Tree to store all the line segments that have a particular point containing a line segment.
 /// </summary>
-AVLTree<Common> C;
-/// <summary>
-/// Creating an AVL Tree to store all the intersection points of the line segments.
-/// </summary>
-AVLTree<Point> finalAns;
+CommonTree C;
 /// <summary>
 /// Creating the Status data structure.
 /// </summary>
 Status T;
+/// <summary>
+/// The B+ Tree Status, used instead of T when it is selected with --status btree.
+/// </summary>
+BTreeStatus<> TB;
+bool btreeStatus = false;
+/// <summary>
+/// Endpoint of a line segment, the record sorted before the sweep and fed into it.
+/// </summary>
+struct EndpointRecord {
+	Point point;
+	Segment segment;
+	/// <summary>
+	/// True, if the point is the upper endpoint of the segment.
+	/// </summary>
+	bool upper;
+};
+
+/// <summary>
+/// Sweep order of the endpoint records: decreasing y, then increasing x, then increasing segment id. It is the
+/// exact order of the coordinates, which std::sort needs; the event queue orders the points within eps in y by x
+/// alone. The ids make it a total order, so that the sort in memory and the merge of the runs on disk put the
+/// line segments of an event point in the same order whatever the memory budget.
+/// </summary>
+struct EndpointOrder {
+	bool operator()(const EndpointRecord& a, const EndpointRecord& b) const {
+		if (a.point.y != b.point.y)
+			return a.point.y > b.point.y;
+		if (a.point.x != b.point.x)
+			return a.point.x < b.point.x;
+		if (a.segment.id != b.segment.id)
+			return a.segment.id < b.segment.id;
+		return a.upper > b.upper;
+	}
+};
+
+/// <summary>
+/// External sorter holding the endpoints, spilling them to disk in the external-memory mode and keeping them all in
+/// memory otherwise. Both modes feed the sweep from it the same way, so they write the same intersection points.
+/// </summary>
+ExternalSorter<EndpointRecord, EndpointOrder>* endpoints = nullptr;
+/// <summary>
+/// Directory for the sorted runs of the external-memory mode.
+/// </summary>
+string tempDir = ".";
+
+/// <summary>
+/// Number of line segments stored in the Common entries of L, U and C.
+/// </summary>
+size_t commonSegments = 0;
+/// <summary>
+/// Statistics of the run.
+/// </summary>
+RunStats stats;
+/// <summary>
+/// Trace of the event points, NULL when tracing is off.
+/// </summary>
+EventTrace* trace = nullptr;
 
 /// <summary>
 /// Function to find a new event point from the current event point being processed.
@@ -59,11 +171,19 @@ Status T;
 void findNewEvent(Segment s1, Segment s2, Point p) {
 
 	Point temp = intersection(s1.p_1, s1.p_2, s2.p_1, s2.p_2);
-
-	if (!doIntersect(s1.p_1, s1.p_2, s2.p_1, s2.p_2))
+	bool intersect = doIntersect(s1.p_1, s1.p_2, s2.p_1, s2.p_2);
+	if (countersOn) {
+		Counters& count = counters();
+		count.intersectionTests++;
+		(intersect ? count.intersectTrue : count.intersectFalse)++;
+	}
+	if (!intersect)
 		return;
-	else if (temp.y < p.y || (abs(temp.y - Segment::k) < 10e-5 && temp.x > p.x)) {
+	if (temp.y < p.y || (abs(temp.y - Segment::k) < 10e-5 && temp.x > p.x)) {
+		size_t pending = eq.size();
 		eq.insert(temp);
+		if (eq.size() == pending && countersOn)	// already an event point
+			counters().duplicateEvents++;
 
 		Common t;
 		t.commonPoint = temp;
@@ -78,174 +198,615 @@ void findNewEvent(Segment s1, Segment s2, Point p) {
 		}
 		else
 			C.insert(t);
+		commonSegments += 2;
+	}
+}
+
+/// <summary>
+/// Function to collect the sorted, distinct ids of the line segments through an event point.
+/// </summary>
+/// <param name="u">Line segments having the point as their upper endpoint.</param>
+/// <param name="l">Line segments having the point as their lower endpoint.</param>
+/// <param name="c">Line segments containing the point.</param>
+/// <param name="ids">Vector which will be changed to the ids.</param>
+void collectSegmentIds(Common* u, Common* l, Common* c, vector<int64_t>& ids) {
+	ids.clear();
+	for (Common* t : { u, l, c })
+		if (t)
+			for (Segment& s : t->segments)
+				ids.push_back(s.id);
+	sort(ids.begin(), ids.end());
+	ids.erase(unique(ids.begin(), ids.end()), ids.end());
+}
+
+/// <summary>
+/// Function to write an intersection point to the output file.
+/// </summary>
+/// <param name="p">The intersection point.</param>
+/// <param name="ids">Sorted ids of the segments through the point.</param>
+/// <param name="count">Number of ids.</param>
+void writeIntersection(const Point& p, const int64_t* ids, size_t count) {
+	if (binaryOutput)
+		binaryFile.write(p, ids, count);
+	else if (segmentIds)
+		outputFile.write(p, ids, count);
+	else
+		outputFile.write(p);
+}
+
+/// <summary>
+/// Function to count an intersection point and stream it to the output, once it left the window of reported points.
+/// </summary>
+/// <param name="p">The intersection point.</param>
+/// <param name="ids">Sorted ids of the segments through the point.</param>
+void emitIntersection(const Point& p, const ReportWindow::Ids& ids) {
+	long long m = ids.size();
+	pointCount++;
+	pairCount += m * (m - 1) / 2;
+	if (countOnly)
+		return;
+
+	if (xOrdered) {
+		if (!xOrdered->add(p, ids.data(), segmentIds ? ids.size() : 0)) {
+			cerr << "Could not write the results to " << tempDir << '\n';
+			exit(1);
+		}
+	}
+	else
+		writeIntersection(p, ids.data(), ids.size());
+
+	if (display)
+		cout << p << ' ';
+}
+
+/// <summary>
+/// Function to report an intersection point, merging it into a point reported within eps before.
+/// </summary>
+/// <param name="p">The intersection point.</param>
+/// <param name="u">Line segments having the point as their upper endpoint.</param>
+/// <param name="l">Line segments having the point as their lower endpoint.</param>
+/// <param name="c">Line segments containing the point.</param>
+void reportIntersection(Point& p, Common* u, Common* l, Common* c) {
+	static vector<int64_t> ids;
+	collectSegmentIds(u, l, c, ids);
+
+	if (reported.add(p, ids.begin(), ids.end(), emitIntersection) && countersOn)	// the same point found again from other segments
+		counters().duplicateReports++;
+}
+
+/// <summary>
+/// Function to add a line segment to the entry of one of its endpoints in L or U.
+/// </summary>
+/// <param name="tree">L or U.</param>
+/// <param name="p">The endpoint.</param>
+/// <param name="s">The line segment.</param>
+void addEndpoint(CommonTree& tree, Point& p, Segment& s) {
+	Common t(p);
+	Node<Common>* temp = tree.search(t);
+
+	if (temp)
+		temp->data.segments.push_back(s);
+	else {
+		t.segments.push_back(s);
+		tree.insert(t);
+	}
+	commonSegments++;
+}
+
+/// <summary>
+/// Function to move the endpoints up to the next pending event point from the sorter into L, U and the
+/// event queue, so that only the endpoints near the sweep line are in the trees.
+/// </summary>
+void feedEndpoints() {
+	// The records the event queue may put before its top are those within eps below it or higher, which are
+	// all before the record of the line eps below the top in the order of the sorter
+	EndpointRecord bound;
+	const EndpointRecord* r;
+	while ((r = endpoints->peek())) {
+		if (!eq.empty()) {
+			bound.point = Point(FLT_MAX, eq.top().y - Point::eps);
+			if (!EndpointOrder()(*r, bound))
+				break;
+		}
+
+		EndpointRecord record;
+		endpoints->next(record);
+		// An intersection found before the endpoint was fed stands for the point in the event queue, and gives way
+		// to it, so that an event point is an endpoint whenever one is within eps; the first endpoint stays
+		Common t(record.point);
+		bool known = U.search(t) || L.search(t);
+		addEndpoint(record.upper ? U : L, record.point, record.segment);
+		if (known)
+			eq.insert(record.point);
+		else
+			eq.assign(record.point);
+	}
+}
+
+/// <summary>
+/// Function to free the entries of an event point in L, U and C once the sweep line has passed it.
+/// </summary>
+/// <param name="p">The event point.</param>
+void releaseEvent(Point& p) {
+	for (CommonTree* tree : { &U, &L, &C }) {
+		Node<Common>* t = tree->search(p);
+		if (t) {
+			commonSegments -= t->data.segments.size();
+			tree->remove(Common(p));
+		}
 	}
 }
 
+/// <summary>
+/// Function to find the entry of an event point in U or L.
+/// </summary>
+/// <param name="tree">U or L.</param>
+/// <param name="p">The event point.</param>
+/// <returns>The entry, NULL if there is none.</returns>
+Common* entryAt(CommonTree& tree, Point& p) {
+	Node<Common>* t = tree.search(p);
+	return t ? &t->data : nullptr;
+}
+
+/// <summary>
+/// Function to find the entry of an event point in C.
+/// </summary>
+/// <param name="p">The event point.</param>
+/// <returns>The entry, NULL if there is none.</returns>
+Common* entryAt(Point& p) {
+	Node<Common>* t = C.search(p);
+	return t ? &t->data : nullptr;
+}
+
+/// <summary>
+/// Function to count the line segments of an entry of L, U or C.
+/// </summary>
+/// <param name="t">The entry, NULL if there is none.</param>
+/// <returns>The number of line segments.</returns>
+uint32_t segmentsAt(Common* t) {
+	return t ? (uint32_t)t->segments.size() : 0;
+}
+
+/// <summary>
+/// Function to estimate the memory held by the sweep data structures.
+/// </summary>
+/// <returns>The number of bytes held by the event queue, the Status, L, U and C.</returns>
+size_t sweepMemory() {
+	return eq.size() * sizeof(Node<Point>) + T.size() * sizeof(Node<Segment>) + TB.bytes()
+		+ (U.size() + L.size() + C.size()) * sizeof(Node<Common>)
+		+ commonSegments * sizeof(Segment);
+}
+
+/// <summary>
+/// Function to get the number of line segments in the Status in use.
+/// </summary>
+size_t statusSize() {
+	return btreeStatus ? TB.size() : T.size();
+}
+
 /// <summary>
 /// Function to handle an event point popped from the event queue.
 /// </summary>
 /// <param name="p">The event point.</param>
-void handleEvent(Point& p) {
+/// <param name="T">The Status in use.</param>
+template <class S>
+void handleEvent(Point& p, S& T) {
+
+	Common* u;
+	Common* l;
+	Common* c;
+	// The segments through p leaving the Status, L and C, and the ones entering it, U and C
+	SegmentSpan<> leaving;
+	SegmentSpan<> entering;
+	bool intersecting;
+	{
+		PHASE_TIMER(Phase::StatusUpdate);
+		u = entryAt(U, p);
+		l = entryAt(L, p);
+		c = entryAt(p);
+
+		if (l)
+			leaving.add(l->segments);
+		if (c)
+			leaving.add(c->segments);
+		leaving.sortUnique();
+		if (u)
+			entering.add(u->segments);
+		if (c)
+			entering.add(c->segments);
+
+		// p is an intersection point when at least two different segments of U, L and C go through it
+		intersecting = leaving.size() > 1
+			|| (!entering.empty() && entering.containsOtherThan(leaving.empty() ? *entering.begin() : leaving.front()));
+	}
 
-	Node<Common>* u = U.search(p);
-	Node<Common>* l = L.search(p);
-	Node<Common>* c = C.search(p);
-	Status union_;
-	union_.clear();
-
-	if (u)
-		for (Segment& s : u->data.segments)
-			union_.insert(s);
-	if (l)
-		for (Segment& s : l->data.segments)
-			union_.insert(s);
-	if (c)
-		for (Segment& s : c->data.segments)
-			union_.insert(s);
-
-	if (union_.getRoot())
-		if (union_.getRoot()->leftChild || union_.getRoot()->rightChild) {
-			if (!finalAns.search(p))
-				outputFile << p.x << ' ' << p.y << '\n';
-			finalAns.insert(p);
-		}
-
-	union_.clear();
-
-	if (l)
-		for (Segment& s : l->data.segments)
-			union_.insert(s);
-	if (c)
-		for (Segment& s : c->data.segments)
-			union_.insert(s);
-
-	T.difference(union_);
-	Segment::k = p.y - (2 * 10e-5);
-
-	if (u)
-		for (Segment& s : u->data.segments)
-			T.insert(s);
-	if (c)
-		for (Segment& s : c->data.segments)
-			T.insert(s);
-
-	union_.clear();
-
-	if (u)
-		for (Segment& s : u->data.segments)
-			union_.insert(s);
-	if (c)
-		for (Segment& s : c->data.segments)
-			union_.insert(s);
-
-	if (!union_.getRoot()) {
-		Segment bLeft = T.leftNeighbourOfPoint(p);
-		Segment bRight = T.rightNeighbourOfPoint(p);
+	if (intersecting) {
+		PHASE_TIMER(Phase::Report);
+		reportIntersection(p, u, l, c);
+	}
+
+	{
+		PHASE_TIMER(Phase::StatusUpdate);
+		// The segments through p are contiguous in the Status, so they leave it, and the ones continuing below p
+		// enter it, as whole blocks in one join-based set operation each
+		T.difference(leaving.begin(), leaving.end());
+		Segment::k = p.y - (2 * 10e-5);
+		entering.sortUnique();
+		T.unionWith(entering.begin(), entering.end());
+	}
+
+	if (entering.empty()) {
+		Segment bLeft;
+		Segment bRight;
+		{
+			PHASE_TIMER(Phase::Neighbours);
+			bLeft = T.leftNeighbourOfPoint(p);
+			bRight = T.rightNeighbourOfPoint(p);
+		}
+		PHASE_TIMER(Phase::FindNewEvent);
 		findNewEvent(bLeft, bRight, p);
 	}
 	else {
 		Segment bLeft;
 		Segment bRight;
-		Segment sLeft = union_.leftMostSegment();
-		Segment sRight = union_.rightMostSegment();
-		bLeft = T.leftNeighbourOfSegment(sLeft);
-		bRight = T.rightNeighbourOfSegment(sRight);
-
-		findNewEvent(bLeft, sLeft, p);
-		findNewEvent(bRight, sRight, p);
+		{
+			PHASE_TIMER(Phase::Neighbours);
+			bLeft = T.leftNeighbourOfSegment(entering.front());
+			bRight = T.rightNeighbourOfSegment(entering.back());
+		}
+		PHASE_TIMER(Phase::FindNewEvent);
+		findNewEvent(bLeft, entering.front(), p);
+		findNewEvent(bRight, entering.back(), p);
 	}
 }
 
-int main() {
+/// <summary>
+/// Function to handle an event point with the Status selected on the command line.
+/// </summary>
+/// <param name="p">The event point.</param>
+void handleEvent(Point& p) {
+	if (btreeStatus)
+		handleEvent(p, TB);
+	else
+		handleEvent(p, T);
+}
 
-	int n;
+/// <summary>
+/// Function to handle an event point and record its span in the trace.
+/// </summary>
+/// <param name="p">The event point.</param>
+void traceEvent(Point& p) {
+	EventSpan span;
+	span.x = p.x;
+	span.y = p.y;
+	span.u = segmentsAt(entryAt(U, p));
+	span.l = segmentsAt(entryAt(L, p));
+	span.c = segmentsAt(entryAt(p));
+
+	span.start = trace->now();
+	handleEvent(p);
+	span.duration = trace->now() - span.start;
+
+	span.status = (uint32_t)statusSize();
+	trace->record(span);
+}
 
-	cout << "Enter the number of line segments: ";
-	cin >> n;
+int main(int argc, char* argv[]) {
+
+	// Parsing the command line flags
+	double quantum = 0;
+	bool external = false;
+	double memoryBudget = 256;
+	double resultMemory = 256;
+	bool byX = false;
+	string inputPath;
+	string statsPath;
+	bool band = false;
+	double yLow = 0, yHigh = 0;
+	string tracePath;
+	size_t traceEvents = 1 << 20;
+	size_t traceTop = 10;
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if (arg == "--no-display")	// skip printing every intersection point to the console
+			display = false;
+		else if (arg == "--binary")	// write ./output.bin instead of ./output.txt
+			binaryOutput = true;
+		else if (arg == "--segment-ids")	// report the ids of all the segments through every point
+			segmentIds = true;
+		else if (arg == "--quantum" && i + 1 < argc)	// store the binary coordinates as multiples of the quantum
+			quantum = atof(argv[++i]);
+		else if (arg == "--external")	// sort the endpoints on disk and stream them into the sweep
+			external = true;
+		else if (arg == "--memory-budget" && i + 1 < argc)	// megabytes the external sort may buffer
+			memoryBudget = atof(argv[++i]);
+		else if (arg == "--temp-dir" && i + 1 < argc)	// directory for the sorted runs
+			tempDir = argv[++i];
+		else if (arg == "--output-order" && i + 1 < argc)	// "sweep" (default) or "x"
+			byX = string(argv[++i]) == "x";
+		else if (arg == "--status" && i + 1 < argc) {	// "avl" (default) or "btree", the data structure of the Status
+			string status = argv[++i];
+			if (status != "avl" && status != "btree") {
+				cerr << "Unknown Status " << status << ", expected avl or btree\n";
+				return 1;
+			}
+			btreeStatus = status == "btree";
+		}
+		else if (arg == "--no-finger")	// search the B+ tree Status from the root, not from the leaf of the last search
+			TB.setFinger(false);
+		else if (arg == "--result-memory" && i + 1 < argc)	// megabytes of results buffered before spilling a run
+			resultMemory = atof(argv[++i]);
+		else if (arg == "--input" && i + 1 < argc)	// read the line segments from a file in the input.txt or binary format
+			inputPath = argv[++i];
+		else if (arg == "--stats-json" && i + 1 < argc)	// write the run statistics as JSON
+			statsPath = argv[++i];
+		else if (arg == "--counters")	// write the operation counters of the sweep to ./counters.json
+			countersOn = true;
+		else if (arg == "--trace" && i + 1 < argc)	// write the spans of the event points in the Chrome trace format
+			tracePath = argv[++i];
+		else if (arg == "--trace-events" && i + 1 < argc)	// number of the latest spans kept for the trace
+			traceEvents = stoull(argv[++i]);
+		else if (arg == "--trace-top" && i + 1 < argc)	// number of the slowest events listed
+			traceTop = stoull(argv[++i]);
+		else if (arg == "--perf-counters")	// report the hardware counters of every phase
+			stats.perf = std::make_unique<PerfCounterSet>();
+		else if (arg == "--count")	// only count the intersections
+			countOnly = true;
+		else if (arg == "--band" && i + 2 < argc) {	// count the crossings between two horizontal lines, without a sweep
+			band = true;
+			yLow = atof(argv[++i]);
+			yHigh = atof(argv[++i]);
+			if (yLow > yHigh)
+				swap(yLow, yHigh);
+		}
+		else
+			cerr << "Unknown flag: " << arg << '\n';
+	}
+
+	if (countOnly || band)
+		display = false;
+	else if (binaryOutput ? !binaryFile.open("./output.bin", segmentIds, quantum) : !outputFile.open("./output.txt")) {
+		cerr << "Could not open the output file\n";
+		return 1;
+	}
+
+	if (byX && !countOnly && !band)
+		xOrdered = new ResultSpill<XOrder>((size_t)(resultMemory * 1024 * 1024), tempDir);
+
+	vector<Segment> bandSegments;
+	if (!band)	// without --external the budget is unbounded, and the endpoints are sorted in memory
+		endpoints = new ExternalSorter<EndpointRecord, EndpointOrder>(external ? (size_t)(memoryBudget * 1024 * 1024) : SIZE_MAX, tempDir);
+
+	uint64_t count = 0;
+	if (stats.perf)
+		stats.perf->start();
+
+	// Reading from a file skips the prompts and leaves ./input.txt alone
+	ifstream inputSource;
+	bool interactive = inputPath.empty();
+	if (!interactive) {
+		inputSource.open(inputPath, ios::binary);
+		if (!inputSource) {
+			cerr << "Could not open " << inputPath << '\n';
+			return 1;
+		}
+	}
+	else
+		inputFile.open("./input.txt");
+	istream& in = interactive ? cin : inputSource;
+
+	// Files written by gen_segments may use the binary format instead of text
+	uint64_t binaryCount;
+	bool binaryInput = !interactive && segment_file::readBinaryHeader(in, binaryCount);
+
+	if (interactive)
+		cout << "Enter the number of line segments: ";
+	if (binaryInput)
+		count = binaryCount;
+	else {
+		long long text = 0;
+		in >> text;
+		count = text < 0 ? 0 : (uint64_t)text;
+	}
+	uint64_t n = count;
 
 	inputFile << n << '\n';
 
 	// Input the line segments and initialize all the required data structures
-	for (int i = 0; i < n; i++) {
+	for (uint64_t i = 0; i < n; i++) {
 		double x1, y1, x2, y2;
-		cout << "Enter the 2 points of the line segment: ";
-		cin >> x1 >> y1 >> x2 >> y2;
+		if (interactive)
+			cout << "Enter the 2 points of the line segment: ";
+		{
+			PHASE_TIMER(Phase::Parse);
+			if (binaryInput) {
+				float v[4];
+				if (!segment_file::readBinary(in, v[0], v[1], v[2], v[3])) {
+					cerr << "Unexpected end of " << inputPath << '\n';
+					return 1;
+				}
+				x1 = v[0], y1 = v[1], x2 = v[2], y2 = v[3];
+			}
+			else
+				in >> x1 >> y1 >> x2 >> y2;
 
-		inputFile << x1 << ' ' << y1 << ' ' << x2 << ' ' << y2 << '\n';
+			inputFile << x1 << ' ' << y1 << ' ' << x2 << ' ' << y2 << '\n';
+		}
 
+		PHASE_TIMER(Phase::Build);
 		Point p1(x1, y1);
 		Point p2(x2, y2);
 
-		Segment s(p1, p2);
-
-		Common t;
-
-		if (p1 > p2) {
-			t.commonPoint = p1;
-			t.segments.push_back(s);
-
-			Node<Common>* temp = L.search(t);
+		Segment s(p1, p2, (int64_t)i);
 
-			if (temp)
-				temp->data.segments.push_back(s);
-			else
-				L.insert(t);
-
-			t.commonPoint = p2;
+		if (band) {
+			bandSegments.push_back(s);
+			continue;
+		}
 
-			temp = U.search(t);
+		Point& upper = (p1 > p2) ? p2 : p1;
+		Point& lower = (p1 > p2) ? p1 : p2;
 
-			if (temp)
-				temp->data.segments.push_back(s);
-			else
-				U.insert(t);
+		// The endpoints are sorted and fed to the sweep later
+		if (!endpoints->push({ upper, s, true }) || !endpoints->push({ lower, s, false })) {
+			cerr << "Could not write a sorted run to " << tempDir << '\n';
+			return 1;
 		}
-		else {
-			t.commonPoint = p2;
-			t.segments.push_back(s);
+	}
 
-			Node<Common>* temp = L.search(t);
+	if (endpoints) {
+		PHASE_TIMER(Phase::Build);
+		if (!endpoints->finish()) {
+			cerr << "Could not write a sorted run to " << tempDir << '\n';
+			return 1;
+		}
+	}
+	stats.sample(sweepMemory(), statusSize(), eq.size());
+
+	if (band) {
+		auto start = chrono::high_resolution_clock::now();
+		size_t skipped;
+		long long crossings = countBandCrossings(bandSegments, yLow, yHigh, skipped);
+		auto stop = chrono::high_resolution_clock::now();
+
+		cout << "\nIntersecting segment pairs between y = " << yLow << " and y = " << yHigh << " : " << crossings;
+		if (skipped)
+			cout << "\nSegments not spanning the band (ignored) : " << skipped;
+		cout << "\nCalculation done in " << chrono::duration_cast<chrono::microseconds>(stop - start).count() << " microseconds.";
+		inputFile.close();
+		return 0;
+	}
 
-			if (temp)
-				temp->data.segments.push_back(s);
-			else
-				L.insert(t);
+	if (stats.perf)
+		stats.perf->endPhase("input");
+	if (!tracePath.empty())
+		trace = new EventTrace(traceEvents, traceTop);
 
-			t.commonPoint = p1;
+	if (display)
+		cout << "\nThe intersection points are : ";
 
-			temp = U.search(t);
+	// Starting the clock to measure time
+	auto start = chrono::high_resolution_clock::now();
 
-			if (temp)
-				temp->data.segments.push_back(s);
+	// Processing all the event points
+	{
+		PHASE_TIMER(Phase::Sweep);
+		while (true) {
+			Point p;
+			{
+				PHASE_TIMER(Phase::EventPop);
+				if (endpoints)
+					feedEndpoints();
+				if (eq.empty())
+					break;
+
+				p = eq.top();
+				eq.pop();
+			}
+			if (trace)
+				traceEvent(p);
 			else
-				U.insert(t);
+				handleEvent(p);
+			{
+				PHASE_TIMER(Phase::StatusUpdate);
+				releaseEvent(p);
+			}
+			stats.events++;
+			stats.sample(sweepMemory(), statusSize(), eq.size());
+
+			if (countersOn) {
+				Counters& count = counters();
+				count.events++;
+				count.maxStatusSize = max(count.maxStatusSize, (long long)statusSize());
+				count.maxEventQueueSize = max(count.maxEventQueueSize, (long long)eq.size());
+				if (count.events % 4096 == 0 || (count.events & (count.events - 1)) == 0) {	// the heights take a walk over the whole trees
+					count.maxStatusHeight = max(count.maxStatusHeight, (long long)(btreeStatus ? TB.treeHeight() : T.treeHeight()));
+					count.maxEventQueueHeight = max(count.maxEventQueueHeight, (long long)eq.height());
+				}
+			}
 		}
-
-		eq.insert(p1);
-		eq.insert(p2);
 	}
 
-	// Starting the clock to measure time
-	auto start = chrono::high_resolution_clock::now();
+	reported.flush(emitIntersection);
+	if (stats.perf)
+		stats.perf->endPhase("sweep");
 
-	// Processing all the event points
-	while (!eq.empty()) {
-		Point p = eq.top();
-		eq.pop();
-		handleEvent(p);
+	// Merging the buffered results into the requested order
+	if (xOrdered) {
+		PHASE_TIMER(Phase::Output);
+		if (!xOrdered->drain(writeIntersection)) {
+			cerr << "Could not read the results back from " << tempDir << '\n';
+			return 1;
+		}
 	}
 
 	// Stopping the clock
 	auto stop = chrono::high_resolution_clock::now();
 	auto duration = chrono::duration_cast<chrono::microseconds>(stop - start);
 
-	cout << "\nThe intersection points are : ";
-	finalAns.display();
-	cout << "\nCalculation done in " << duration.count() << " microseconds.";
+	bool outputFailed = false;	// a write of the results fell short, e.g. on a full disk
+	{
+		PHASE_TIMER(Phase::Output);
+		inputFile.close();
+		if (!outputFile.close()) {
+			cerr << "Could not write the intersection points to ./output.txt\n";
+			outputFailed = true;
+		}
+		if (!binaryFile.close()) {
+			cerr << "Could not write the intersection points to ./output.bin\n";
+			outputFailed = true;
+		}
+	}
+
+	if (stats.perf)
+		stats.perf->endPhase("output");
+
+	{
+		PHASE_TIMER(Phase::Teardown);
+		delete endpoints;
+		delete xOrdered;
+		endpoints = nullptr;
+		xOrdered = nullptr;
+		T.clear();
+		TB.clear();
+		U.clear();
+		L.clear();
+		C.clear();
+	}
+	if (stats.perf)
+		stats.perf->endPhase("teardown");
 
-	inputFile.close();
-	outputFile.close();
+	if (display)
+		cout << endl;
+	cout << "\nIntersection points : " << pointCount;
+	cout << "\nIntersecting segment pairs : " << pairCount;
+	cout << "\nCalculation done in " << duration.count() << " microseconds.";
+	stats.print(cout);
+	MemoryAccounting::print(cout);
+	PhaseTimes::print(cout);
+	if (stats.perf)
+		stats.perf->print(cout);
+
+	stats.segments = n;
+	stats.points = pointCount;
+	stats.pairs = pairCount;
+	stats.sweepMicroseconds = duration.count();
+	if (!statsPath.empty()) {
+		ofstream statsFile(statsPath);
+		stats.writeJson(statsFile);
+	}
+	if (countersOn) {
+		ofstream countersFile("./counters.json");
+		ThreadCounters::merged().writeJson(countersFile);
+	}
+	if (trace) {
+		trace->printSummary(cout);
+		if (!trace->writeChromeTrace(tracePath))
+			cerr << "Could not write " << tracePath << '\n';
+		delete trace;
+	}
+	stats.perf.reset();
 
 	//system("python plotter.py");
-	return 0;
+	return outputFailed ? 1 : 0;
 }
\ No newline at end of file
@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../include/AVLTree/tree.hpp"
+
+using namespace std;
+
+typedef AVLTree<int> Tree;
+
+/// <summary>
+/// Number of failed checks.
+/// </summary>
+int failures = 0;
+
+/// <summary>
+/// Function to check the AVL invariants of a subtree and collect its elements in order.
+/// </summary>
+/// <param name="node">The root node of the subtree.</param>
+/// <param name="out">Vector the elements are appended to.</param>
+/// <param name="valid">Set to false if the height, the count or the balance of a node is wrong.</param>
+/// <returns>The height of the subtree.</returns>
+int walk(Node<int>* node, vector<int>& out, bool& valid) {
+	if (node == nullptr)
+		return 0;
+	size_t first = out.size();
+	int l = walk(node->leftChild, out, valid);
+	out.push_back(node->data);
+	int r = walk(node->rightChild, out, valid);
+	if (node->height != max(l, r) + 1 || node->count != out.size() - first || abs(l - r) > 1)
+		valid = false;
+	return max(l, r) + 1;
+}
+
+/// <summary>
+/// Function to compare an AVL Tree with the std::set of the elements it should hold.
+/// </summary>
+/// <param name="what">Name of the check, printed if it fails.</param>
+void check(const string& what, Tree& tree, const set<int>& expected) {
+	vector<int> elements;
+	bool valid = true;
+	walk(tree.getRoot(), elements, valid);
+	if (!valid || tree.size() != expected.size() || !equal(elements.begin(), elements.end(), expected.begin(), expected.end())) {
+		cerr << what << ": " << (valid ? "" : "AVL invariants broken, ") << elements.size() << " elements instead of "
+			<< expected.size() << (valid ? ", or different ones" : "") << '\n';
+		failures++;
+	}
+}
+
+/// <summary>
+/// Function to draw a set of distinct random keys.
+/// </summary>
+/// <param name="n">Number of draws, duplicates being dropped.</param>
+/// <param name="range">Keys are drawn in [0, range).</param>
+set<int> randomKeys(size_t n, int range, mt19937_64& rng) {
+	uniform_int_distribution<int> key(0, range - 1);
+	set<int> keys;
+	for (size_t i = 0; i < n; i++)
+		keys.insert(key(rng));
+	return keys;
+}
+
+/// <summary>
+/// Function to fill an AVL Tree, either one insertion at a time or built from the sorted keys.
+/// </summary>
+void fill(Tree& tree, const set<int>& keys, bool build) {
+	tree.clear();
+	if (build) {
+		vector<int> sorted(keys.begin(), keys.end());
+		tree.build(sorted.begin(), sorted.end());
+	}
+	else {
+		for (int k : keys)
+			tree.insert(k);
+	}
+}
+
+/// <summary>
+/// Checks the split, join, union, difference and intersection of AVLTree against std::set, on small trees and on
+/// trees of tens of thousands of nodes, where the set operations hand subtrees above AVLTree's parallelGrain (4096
+/// nodes) to other threads. The trees carry no destructor, so every one is cleared and no node may be left allocated.
+/// </summary>
+int main() {
+
+	mt19937_64 rng(1);
+	struct Size {
+		size_t a, b;
+		int range;
+	};
+	// Small, unbalanced and large pairs, with key ranges giving few or many common elements
+	const vector<Size> sizes = { { 0, 10, 20 }, { 10, 0, 20 }, { 50, 50, 60 }, { 200, 5, 1000 }, { 5, 200, 1000 },
+		{ 3000, 3000, 4000 }, { 50000, 20000, 60000 }, { 20000, 50000, 1000000 }, { 60000, 60000, 80000 } };
+	const vector<unsigned> threadCounts = { 1, 4 };
+
+	for (const Size& size : sizes) {
+		for (unsigned threads : threadCounts) {
+			for (int round = 0; round < 2; round++) {
+				set<int> a = randomKeys(size.a, size.range, rng), b = randomKeys(size.b, size.range, rng);
+				string name = to_string(a.size()) + " and " + to_string(b.size()) + " elements, " + to_string(threads) + " threads";
+				bool build = round == 1;
+				Tree ta, tb;
+
+				// union
+				fill(ta, a, build);
+				fill(tb, b, !build);
+				set<int> expected = a;
+				expected.insert(b.begin(), b.end());
+				ta.unionWith(tb, threads);
+				check("union of " + name, ta, expected);
+				check("union of " + name + ", the other tree", tb, set<int>());
+
+				// difference
+				fill(ta, a, build);
+				fill(tb, b, !build);
+				expected.clear();
+				set_difference(a.begin(), a.end(), b.begin(), b.end(), inserter(expected, expected.end()));
+				ta.difference(tb, threads);
+				check("difference of " + name, ta, expected);
+				check("difference of " + name + ", the other tree", tb, b);
+
+				// intersection
+				fill(ta, a, build);
+				expected.clear();
+				set_intersection(a.begin(), a.end(), b.begin(), b.end(), inserter(expected, expected.end()));
+				ta.intersection(tb, threads);
+				check("intersection of " + name, ta, expected);
+				check("intersection of " + name + ", the other tree", tb, b);
+
+				// union and difference of sorted ranges
+				vector<int> range(b.begin(), b.end());
+				fill(ta, a, build);
+				expected = a;
+				expected.insert(b.begin(), b.end());
+				ta.unionWith(range.begin(), range.end());
+				check("union of a range, " + name, ta, expected);
+				fill(ta, a, build);
+				expected.clear();
+				set_difference(a.begin(), a.end(), b.begin(), b.end(), inserter(expected, expected.end()));
+				ta.difference(range.begin(), range.end());
+				check("difference of a range, " + name, ta, expected);
+
+				ta.clear();
+				tb.clear();
+			}
+		}
+	}
+
+	// split at keys before, inside and after the elements, present or not, then join back
+	for (size_t n : { 0, 1, 2, 100, 5000, 50000 }) {
+		set<int> keys = randomKeys(n, (int)(2 * n + 2), rng);
+		vector<int> splits = { -1, 0, (int)n, (int)(2 * n + 5) };
+		for (int i = 0; i < 20; i++)
+			splits.push_back(uniform_int_distribution<int>(0, (int)(2 * n + 2))(rng));
+		for (int key : splits) {
+			string name = "split of " + to_string(keys.size()) + " elements at " + to_string(key);
+			Tree left, right;
+			fill(left, keys, key % 2 == 0);
+			left.split(key, right);
+			check(name + ", left", left, set<int>(keys.begin(), keys.lower_bound(key)));
+			check(name + ", right", right, set<int>(keys.lower_bound(key), keys.end()));
+			left.join(right);
+			check(name + ", joined back", left, keys);
+			check(name + ", joined back, the other tree", right, set<int>());
+			left.clear();
+		}
+	}
+
+	// insertions and removals
+	{
+		Tree tree;
+		set<int> expected;
+		uniform_int_distribution<int> key(0, 5000);
+		for (int i = 0; i < 200000; i++) {
+			int k = key(rng);
+			if (rng() % 3) {
+				tree.insert(k);
+				expected.insert(k);
+			}
+			else {
+				tree.remove(k);
+				expected.erase(k);
+			}
+			if (i % 20000 == 0)
+				check("insertions and removals, step " + to_string(i), tree, expected);
+			if (i % 50000 == 0 && !expected.empty()) {
+				tree.removeMin();
+				expected.erase(expected.begin());
+			}
+		}
+		check("insertions and removals", tree, expected);
+		tree.clear();
+	}
+
+	long long live = MemoryAccounting::usage(MemoryTag::Other).live.load();
+	if (live != 0) {
+		cerr << live << " bytes of nodes were not freed\n";
+		failures++;
+	}
+
+	if (failures)
+		cerr << failures << " checks failed\n";
+	else
+		cout << "All the set operations match std::set\n";
+	return failures ? 1 : 0;
+}
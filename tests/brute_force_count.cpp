@@ -0,0 +1,127 @@
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../include/gen/workloads.hpp"
+
+using namespace std;
+
+/// <summary>
+/// Distance in x and in y under which two intersection points are the same, Point::eps.
+/// </summary>
+const double eps = 10e-5;
+
+/// <summary>
+/// Input to sweep, and whether the sweep must find all of its intersection points.
+/// </summary>
+struct Case {
+	string distribution;
+	size_t n;
+	uint64_t seed;
+	bool exact;
+};
+
+struct XY {
+	double x, y;
+};
+
+/// <summary>
+/// Function to compute the intersection point of two line segments the slow way.
+/// </summary>
+/// <param name="p">Vector the intersection point is appended to, if the segments intersect in one point.</param>
+void intersect(const RawSegment& a, const RawSegment& b, vector<XY>& p) {
+	double d = (a.x1 - a.x2) * (b.y1 - b.y2) - (a.y1 - a.y2) * (b.x1 - b.x2);
+	if (d == 0)
+		return;
+	double t = ((a.x1 - b.x1) * (b.y1 - b.y2) - (a.y1 - b.y1) * (b.x1 - b.x2)) / d;
+	double u = -((a.x1 - a.x2) * (a.y1 - b.y1) - (a.y1 - a.y2) * (a.x1 - b.x1)) / d;
+	if (t >= 0 && t <= 1 && u >= 0 && u <= 1)
+		p.push_back({ a.x1 + t * (a.x2 - a.x1), a.y1 + t * (a.y2 - a.y1) });
+}
+
+/// <summary>
+/// Function to tell if a point is within a distance of one of the points of a vector, in x and in y.
+/// </summary>
+bool near(const XY& p, const vector<XY>& points, size_t count, double distance) {
+	for (size_t i = 0; i < count; i++)
+		if (abs(points[i].x - p.x) < distance && abs(points[i].y - p.y) < distance)
+			return true;
+	return false;
+}
+
+/// <summary>
+/// Checks the intersection points found by the sweep against all the pairs of line segments compared with each
+/// other: every point written must be an intersection, written once, and on the inputs the sweep handles fully the
+/// number of points must be the number of distinct intersections. The sweep still misses intersections of dense
+/// inputs, whose line segments get out of order in the Status, so those are only checked for wrong points.
+/// </summary>
+int main(int argc, char* argv[]) {
+
+	string daa = argc > 1 ? argv[1] : DAA_PATH;
+	char dirTemplate[] = "/tmp/daa_brute_force_XXXXXX";
+	if (!mkdtemp(dirTemplate)) {
+		cerr << "Could not create a working directory\n";
+		return 1;
+	}
+	string dir = dirTemplate;
+
+	const vector<Case> cases = { { "roads", 40, 3, true }, { "roads", 40, 1, true }, { "poisson", 200, 1, true },
+		{ "poisson", 200, 3, true }, { "roads", 200, 2, false }, { "roads", 200, 3, false }, { "uniform", 40, 1, false },
+		{ "uniform", 200, 2, false } };
+	vector<RawSegment> segments;
+	bool ok = true;
+
+	for (const Case& c : cases) {
+		string name = c.distribution + " n=" + to_string(c.n) + " seed " + to_string(c.seed);
+		generateDistribution(c.distribution, c.n, c.seed, segments);
+		writeSegments(dir + "/input.txt", segments);
+		remove((dir + "/output.txt").c_str());
+		string command = "cd " + dir + " && " + daa + " --input input.txt --no-display > /dev/null 2>&1";
+		int status = system(command.c_str());
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			cerr << name << ": the run failed\n";
+			ok = false;
+			continue;
+		}
+
+		vector<XY> all, distinct, found;
+		for (size_t i = 0; i < segments.size(); i++)
+			for (size_t j = 0; j < i; j++)
+				intersect(segments[i], segments[j], all);
+		for (const XY& p : all)
+			if (!near(p, distinct, distinct.size(), eps))
+				distinct.push_back(p);
+
+		ifstream output(dir + "/output.txt");
+		XY p;
+		while (output >> p.x >> p.y)
+			found.push_back(p);
+
+		size_t wrong = 0, twice = 0;
+		for (size_t i = 0; i < found.size(); i++) {
+			if (!near(found[i], distinct, distinct.size(), 1e-2))	// the points are written as floats
+				wrong++;
+			if (near(found[i], found, i, eps))
+				twice++;
+		}
+		cout << name << ": " << found.size() << " points found, " << distinct.size() << " intersections\n";
+
+		if (wrong || twice) {
+			cerr << name << ": " << wrong << " points are no intersection, " << twice << " are written twice\n";
+			ok = false;
+		}
+		if (c.exact && found.size() != distinct.size()) {
+			cerr << name << ": " << found.size() << " intersection points instead of " << distinct.size() << '\n';
+			ok = false;
+		}
+	}
+
+	system(("rm -rf " + dir).c_str());
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../include/gen/workloads.hpp"
+
+using namespace std;
+
+/// <summary>
+/// Number of line segments of every input, so that only the number of intersections changes between the runs.
+/// </summary>
+const size_t segmentCount = 2000;
+
+/// <summary>
+/// Function to read a number from the flat JSON object written by --stats-json.
+/// </summary>
+/// <param name="json">The JSON text.</param>
+/// <param name="key">The key.</param>
+/// <returns>The number, -1 if the key is missing.</returns>
+double jsonNumber(const string& json, const string& key) {
+	size_t at = json.find("\"" + key + "\":");
+	if (at == string::npos)
+		return -1;
+	return atof(json.c_str() + at + key.size() + 3);
+}
+
+/// <summary>
+/// Function to build an input of segmentCount line segments with m^2 intersections: m slightly tilted rows
+/// crossing m slightly tilted columns, and parallel segments of the same height beside the crossing part, so that
+/// as many segments cross the sweep line whatever m.
+/// </summary>
+/// <param name="m">Number of rows and of columns.</param>
+/// <param name="segments">Vector which will be changed to the line segments.</param>
+void crossingInput(size_t m, vector<RawSegment>& segments) {
+	segments.clear();
+	double step = workloadSide / m;
+	for (size_t i = 0; i < m; i++) {
+		double at = (i + 0.5) * step;
+		segments.push_back({ 0, at, workloadSide, at + 0.25 * step });
+		segments.push_back({ at, 0, at + 0.25 * step, workloadSide });
+	}
+	for (size_t i = 0; segments.size() < segmentCount; i++) {
+		double x = 2 * workloadSide + (double)i * 2;
+		segments.push_back({ x, 0, x + 1, workloadSide });
+	}
+}
+
+/// <summary>
+/// Checks that the memory held for the results does not grow with the number of intersections k: the same number
+/// of line segments is swept with k from 10^4 to 10^6, in both output formats, and the peaks are compared.
+/// </summary>
+int main(int argc, char* argv[]) {
+
+	string daa = argc > 1 ? argv[1] : DAA_PATH;
+	char dirTemplate[] = "/tmp/daa_memory_flat_XXXXXX";
+	if (!mkdtemp(dirTemplate)) {
+		cerr << "Could not create a working directory\n";
+		return 1;
+	}
+	string dir = dirTemplate;
+
+	const vector<size_t> sides = { 100, 300, 1000 };
+	const vector<string> formats = { "", "--binary" };
+	vector<RawSegment> segments;
+	bool ok = true;
+
+	for (const string& format : formats) {
+		double firstResults = 0, firstTotal = 0;
+		for (size_t m : sides) {
+			crossingInput(m, segments);
+			writeSegments(dir + "/input.txt", segments);
+			string command = "cd " + dir + " && " + daa + " --input input.txt --no-display --stats-json stats.json " + format + " > /dev/null 2>&1";
+			remove((dir + "/stats.json").c_str());
+			int status = system(command.c_str());
+
+			ifstream statsFile(dir + "/stats.json");
+			string json((istreambuf_iterator<char>(statsFile)), istreambuf_iterator<char>());
+			double points = jsonNumber(json, "intersection_points");
+			double results = jsonNumber(json, "memory_results_peak_bytes");
+			double total = jsonNumber(json, "memory_total_peak_bytes");
+			string name = (format.empty() ? "text" : "binary") + string(" k=") + to_string(m * m);
+			cout << name << ": results peak " << (long long)results << " bytes, total peak " << (long long)total << " bytes\n";
+
+			if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || results < 0 || total < 0) {
+				cerr << name << ": the run failed\n";
+				ok = false;
+				break;
+			}
+			if (points < 0.9 * m * m) {		// a few of the closest points round to the same floats
+				cerr << name << ": " << (long long)points << " intersection points instead of about " << m * m << '\n';
+				ok = false;
+			}
+			if (m == sides[0]) {
+				firstResults = results;
+				firstTotal = total;
+			}
+			// k grows 100 times while the peaks may only drift by the binary block index, 24 bytes per 4096 points
+			else if (results > firstResults + 64 * 1024 || total > 1.25 * firstTotal) {
+				cerr << name << ": the memory grows with k, from " << (long long)firstResults << " / " << (long long)firstTotal
+					<< " bytes at k=" << sides[0] * sides[0] << '\n';
+				ok = false;
+			}
+		}
+	}
+
+	system(("rm -rf " + dir).c_str());
+	return ok ? 0 : 1;
+}
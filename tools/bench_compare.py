@@ -0,0 +1,199 @@
+"""
+Stores the JSON results of the bench runner under labelled baselines and compares new runs against them.
+
+    python tools/bench_compare.py save <label> results.json [more.json ...]
+    python tools/bench_compare.py list
+    python tools/bench_compare.py compare <label> results.json [--threshold 5] [--alpha 0.05]
+
+A comparison groups the records by workload, n and engine and tests every metric (wall time, sweep time
+and the time of every phase) with a two-sided permutation test of the difference of the means over the
+repeats. A change is significant when its p-value is below alpha; the exit code is 1 when a significant
+slowdown is larger than the threshold (in percent), so the tool can gate a build. With too few repeats no
+p-value can get below alpha (2 / C(6, 3) = 0.1 with 3 against 3), so the comparison fails with exit code 2
+instead of passing whatever the change.
+"""
+
+import argparse
+import itertools
+import json
+import os
+import random
+import subprocess
+import sys
+import time
+
+dirname = os.path.dirname(os.path.abspath(__file__))
+default_store = os.path.join(dirname, '..', 'bench', 'baselines')
+
+
+def load_records(paths):
+    records = []
+    for path in paths:
+        with open(path) as f:
+            data = json.load(f)
+        records += data['records'] if isinstance(data, dict) else data
+    return records
+
+
+def git_commit():
+    try:
+        return subprocess.check_output(['git', 'rev-parse', '--short', 'HEAD'], cwd=dirname,
+                                       stderr=subprocess.DEVNULL).decode().strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def samples(records):
+    """Groups the successful runs by (workload, n, engine), as {metric: [values over the repeats]}."""
+    groups = {}
+    for r in records:
+        if not r.get('ok'):
+            continue
+        key = (r['workload'], r['n'], r['engine'])
+        metrics = groups.setdefault(key, {})
+        metrics.setdefault('wall_s', []).append(r['wall_s'])
+        metrics.setdefault('sweep_s', []).append(r['sweep_s'])
+        for phase, us in r.get('phases_us', {}).items():
+            metrics.setdefault('phase:' + phase, []).append(us / 1e6)
+    return groups
+
+
+def permutation_test(a, b, rounds=20000):
+    """Two-sided p-value of the difference of the means of a and b, exact when the splits are few enough."""
+    pooled = a + b
+    observed = abs(sum(a) / len(a) - sum(b) / len(b))
+    total = sum(pooled)
+
+    def extreme(first):
+        s = sum(first)
+        diff = abs(s / len(a) - (total - s) / len(b))
+        return diff >= observed - 1e-12
+
+    n_splits = 1
+    for i in range(len(a)):
+        n_splits = n_splits * (len(pooled) - i) // (i + 1)
+    if n_splits <= rounds:
+        hits = sum(extreme(c) for c in itertools.combinations(pooled, len(a)))
+        return hits / n_splits
+
+    rng = random.Random(1)
+    hits = 0
+    for _ in range(rounds):
+        rng.shuffle(pooled)
+        hits += extreme(pooled[:len(a)])
+    return (hits + 1) / (rounds + 1)
+
+
+def smallest_p(na, nb, rounds=20000):
+    """Smallest p-value permutation_test can return for samples of na and nb values."""
+    n_splits = 1
+    for i in range(na):
+        n_splits = n_splits * (na + nb - i) // (i + 1)
+    if n_splits > rounds:
+        return 1 / (rounds + 1)
+    # With equal sizes the mirror of the observed split is as extreme as it
+    return (2 if na == nb else 1) / n_splits
+
+
+def median(v):
+    v = sorted(v)
+    m = len(v) // 2
+    return v[m] if len(v) % 2 else (v[m - 1] + v[m]) / 2
+
+
+def save(args):
+    os.makedirs(args.store, exist_ok=True)
+    records = load_records(args.results)
+    baseline = {'label': args.label, 'created': time.strftime('%Y-%m-%d %H:%M:%S'), 'commit': git_commit(),
+                'records': records}
+    path = os.path.join(args.store, args.label + '.json')
+    with open(path, 'w') as f:
+        json.dump(baseline, f, indent=1)
+    print('Saved %d records as %s' % (len(records), path))
+    return 0
+
+
+def list_baselines(args):
+    if not os.path.isdir(args.store):
+        return 0
+    for name in sorted(os.listdir(args.store)):
+        if name.endswith('.json'):
+            with open(os.path.join(args.store, name)) as f:
+                b = json.load(f)
+            print('%-24s %s  commit %s  %d records' % (b['label'], b['created'], b['commit'], len(b['records'])))
+    return 0
+
+
+def compare(args):
+    path = os.path.join(args.store, args.label + '.json')
+    if not os.path.exists(path):
+        print('No baseline %s in %s' % (args.label, args.store), file=sys.stderr)
+        return 2
+    base = samples(load_records([path]))
+    new = samples(load_records(args.results))
+
+    regressions = 0
+    untestable = []
+    print('%-32s %-20s %12s %12s %9s %8s  %s' % ('workload / n / engine', 'metric', 'baseline', 'new', 'change', 'p', ''))
+    for key in sorted(set(base) & set(new)):
+        for metric in sorted(set(base[key]) & set(new[key])):
+            a, b = base[key][metric], new[key][metric]
+            old_m, new_m = median(a), median(b)
+            if old_m <= 0:
+                continue
+            change = 100 * (new_m - old_m) / old_m
+            p = permutation_test(a, b) if len(a) > 1 and len(b) > 1 else 1.0
+            if metric in args.gate and (len(a) < 2 or len(b) < 2 or smallest_p(len(a), len(b)) >= args.alpha):
+                untestable.append((key, metric, len(a), len(b)))
+            verdict = ''
+            if p < args.alpha and abs(change) >= args.min_change:
+                verdict = 'slower' if change > 0 else 'faster'
+                if change > args.threshold and metric in args.gate:
+                    verdict += '  REGRESSION'
+                    regressions += 1
+            if verdict or args.all:
+                print('%-32s %-20s %12.6f %12.6f %+8.1f%% %8.4f  %s' % ('%s / %d / %s' % key, metric, old_m, new_m, change, p, verdict))
+
+    missing = sorted(set(base) - set(new))
+    if missing:
+        print('\n%d baseline groups were not run or failed, e.g. %s / %d / %s' % ((len(missing),) + missing[0]))
+    print('\n%d significant slowdowns above %.1f%%' % (regressions, args.threshold))
+    if untestable:
+        key, metric, na, nb = untestable[0]
+        print('\nERROR: %d gated metrics have too few repeats to ever be significant at alpha = %g, e.g. %s of '
+              '%s / %d / %s with %d baseline and %d new repeats; run the bench with --repeat 5 or more'
+              % ((len(untestable), args.alpha, metric) + key + (na, nb)), file=sys.stderr)
+        return 2
+    return 1 if regressions else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Benchmark baselines and regression checks.')
+    parser.add_argument('--store', default=default_store, help='directory of the baselines')
+    sub = parser.add_subparsers(dest='command', required=True)
+
+    p = sub.add_parser('save', help='store results under a label')
+    p.add_argument('label')
+    p.add_argument('results', nargs='+')
+    p.set_defaults(run=save)
+
+    p = sub.add_parser('list', help='list the baselines')
+    p.set_defaults(run=list_baselines)
+
+    p = sub.add_parser('compare', help='compare results against a baseline')
+    p.add_argument('label')
+    p.add_argument('results', nargs='+')
+    p.add_argument('--threshold', type=float, default=5, help='slowdown in percent that fails the comparison')
+    p.add_argument('--alpha', type=float, default=0.05, help='significance level of the permutation test')
+    p.add_argument('--min-change', type=float, default=1, help='smallest change in percent reported')
+    p.add_argument('--gate', nargs='+', default=['wall_s', 'sweep_s'],
+                   help='metrics whose slowdowns fail the comparison, e.g. phase:sweep')
+    p.add_argument('--all', action='store_true', help='also print the metrics which did not change')
+    p.set_defaults(run=compare)
+
+    args = parser.parse_args()
+    sys.exit(args.run(args))
+
+
+if __name__ == '__main__':
+    main()
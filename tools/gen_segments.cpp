@@ -0,0 +1,135 @@
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/gen/workloads.hpp"
+#include "../include/io/segment_file.hpp"
+
+using namespace std;
+
+/// <summary>
+/// Line segments of a chunk, formatted for the output file.
+/// </summary>
+struct ChunkBuffer {
+	vector<RawSegment> segments;
+	vector<char> bytes;
+};
+
+/// <summary>
+/// Function to generate a chunk and format it.
+/// </summary>
+void formatChunk(const GeneratorOptions& o, uint64_t chunk, bool binary, ChunkBuffer& b) {
+	generateChunk(o, chunk, b.segments);
+	b.bytes.clear();
+	b.bytes.reserve(b.segments.size() * (binary ? segment_file::recordSize : 48));
+	for (const RawSegment& s : b.segments) {
+		if (binary)
+			segment_file::appendBinary(b.bytes, (float)s.x1, (float)s.y1, (float)s.x2, (float)s.y2);
+		else
+			segment_file::appendText(b.bytes, (float)s.x1, (float)s.y1, (float)s.x2, (float)s.y2);
+	}
+}
+
+/// <summary>
+/// Writes seeded line segment inputs for the sweep. The chunks are generated and formatted in parallel,
+/// a batch of them at a time, while the previous batch is written out; the output only depends on the options.
+/// </summary>
+int main(int argc, char* argv[]) {
+
+	GeneratorOptions o;
+	string outPath = "input.txt";
+	bool binary = false;
+	unsigned threads = max(1u, thread::hardware_concurrency());
+
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		if (arg == "--distribution" && i + 1 < argc)
+			o.distribution = argv[++i];
+		else if (arg == "--n" && i + 1 < argc)
+			o.n = stoull(argv[++i]);
+		else if (arg == "--seed" && i + 1 < argc)
+			o.seed = stoull(argv[++i]);
+		else if (arg == "--mean-length" && i + 1 < argc)
+			o.meanLength = stod(argv[++i]);
+		else if (arg == "--crossings" && i + 1 < argc)
+			o.crossings = stoull(argv[++i]);
+		else if (arg == "--polyline" && i + 1 < argc)
+			o.polylineLength = stoull(argv[++i]);
+		else if (arg == "--threads" && i + 1 < argc)
+			threads = max(1, atoi(argv[++i]));
+		else if (arg == "--binary")
+			binary = true;
+		else if (arg == "--out" && i + 1 < argc)
+			outPath = argv[++i];
+		else {
+			cerr << "Usage: " << argv[0] << " [--distribution d] [--n N] [--seed S] [--binary] [--out input.txt] [--threads T]\n"
+				<< "       [--mean-length L] [--crossings k] [--polyline P]\n"
+				<< "Distributions:";
+			for (const string& d : distributionNames())
+				cerr << ' ' << d;
+			cerr << '\n';
+			return 1;
+		}
+	}
+
+	bool known = false;
+	for (const string& d : distributionNames())
+		known = known || d == o.distribution;
+	if (!known) {
+		cerr << "Unknown distribution " << o.distribution << '\n';
+		return 1;
+	}
+	if (o.distribution == "crossing") {
+		uint64_t rows, cols;
+		crossingFamilies(o.crossings, rows, cols);
+		if (rows + cols > o.n) {
+			cerr << o.crossings << " crossings need at least " << rows + cols << " segments\n";
+			return 1;
+		}
+	}
+
+	FILE* file = fopen(outPath.c_str(), "wb");
+	if (!file) {
+		cerr << "Could not open " << outPath << '\n';
+		return 1;
+	}
+
+	vector<char> header;
+	if (binary)
+		segment_file::appendBinaryHeader(header, o.n);
+	else {
+		string count = to_string(o.n) + '\n';
+		header.assign(count.begin(), count.end());
+	}
+	bool ok = fwrite(header.data(), 1, header.size(), file) == header.size();
+
+	// Two sets of buffers: the workers fill one batch while the other is written
+	uint64_t chunks = (o.n + generatorChunk - 1) / generatorChunk;
+	vector<ChunkBuffer> buffers[2] = { vector<ChunkBuffer>(threads), vector<ChunkBuffer>(threads) };
+
+	for (uint64_t batch = 0; batch * threads < chunks + threads && ok; batch++) {
+		uint64_t begin = batch * threads;
+		vector<thread> workers;
+		for (unsigned t = 0; t < threads && begin + t < chunks; t++)
+			workers.emplace_back(formatChunk, cref(o), begin + t, binary, ref(buffers[batch % 2][t]));
+
+		if (batch > 0) {
+			uint64_t previous = begin - threads;
+			for (unsigned t = 0; t < threads && previous + t < chunks && ok; t++) {
+				vector<char>& bytes = buffers[(batch - 1) % 2][t].bytes;
+				ok = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+			}
+		}
+
+		for (thread& w : workers)
+			w.join();
+	}
+
+	if (fclose(file) != 0 || !ok) {
+		cerr << "Could not write " << outPath << '\n';
+		return 1;
+	}
+	return 0;
+}
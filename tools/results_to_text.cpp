@@ -0,0 +1,23 @@
+#include <iostream>
+
+#include "../include/io/binary_results.hpp"
+
+using namespace std;
+
+/// <summary>
+/// Converts a binary result file written with --binary back into the text format of output.txt.
+/// </summary>
+int main(int argc, char* argv[]) {
+
+	if (argc != 3) {
+		cerr << "Usage: " << argv[0] << " <output.bin> <output.txt>\n";
+		return 1;
+	}
+
+	string error;
+	if (!binaryToText(argv[1], argv[2], error)) {
+		cerr << "Could not convert " << argv[1] << ": " << error << '\n';
+		return 1;
+	}
+	return 0;
+}